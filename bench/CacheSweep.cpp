@@ -0,0 +1,162 @@
+#include "CacheSweep.hpp"
+
+#include "athena/polygonizer/GridCache.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+using athena::polygonizer::PointCache;
+using athena::polygonizer::invalidUint;
+using athena::polygonizer::PointId;
+using athena::polygonizer::VoxelSet;
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedNs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(
+        Clock::now() - start).count();
+}
+
+// The voxels crossed by two concentric rings, which is roughly what the
+// surface march of a single slice of a blob visits.
+std::vector<PointId> makeWalk(std::uint32_t gridSize)
+{
+    std::vector<PointId> walk;
+    float centre = gridSize / 2.0f;
+    for (float radius : { 0.35f * gridSize, 0.2f * gridSize })
+    {
+        auto steps = static_cast<std::size_t>(16.0f * radius);
+        for (std::size_t i = 0; i < steps; ++i)
+        {
+            float angle = 6.2831853f * i / steps;
+            PointId id(
+                static_cast<std::uint32_t>(centre + radius * std::cos(angle)),
+                static_cast<std::uint32_t>(centre + radius * std::sin(angle)));
+            if (walk.empty() || walk.back() != id)
+            {
+                walk.push_back(id);
+            }
+        }
+    }
+
+    return walk;
+}
+
+// Mirrors the growth policy of FlatHashMap.
+std::size_t hashBytes(std::size_t size, std::size_t entryBytes)
+{
+    std::size_t capacity = 16;
+    while (capacity < size * 2)
+    {
+        capacity *= 2;
+    }
+
+    return capacity * entryBytes;
+}
+
+CacheSample runSweep(std::uint32_t gridSize, bool dense,
+    std::vector<PointId> const& walk, std::size_t repetitions)
+{
+    std::size_t maxDensePoints =
+        (dense) ? std::numeric_limits<std::size_t>::max() : 0;
+
+    CacheSample sample;
+    sample.gridSize = gridSize;
+    sample.dense = dense;
+    sample.lookups = 0;
+    sample.resetNs = std::numeric_limits<double>::max();
+    sample.nsPerLookup = std::numeric_limits<double>::max();
+
+    PointCache points;
+    VoxelSet voxels;
+    std::size_t checksum = 0;
+    for (std::size_t r = 0; r < repetitions; ++r)
+    {
+        auto start = Clock::now();
+        points.reset(gridSize, maxDensePoints);
+        voxels.reset(gridSize, maxDensePoints);
+        sample.resetNs = std::min(sample.resetNs, elapsedNs(start));
+
+        // Same pattern as the march: check the voxel and its neighbours,
+        // then look up (or add) each of its corners.
+        std::size_t lookups = 0;
+        std::uint32_t next = 0;
+        start = Clock::now();
+        for (auto const& id : walk)
+        {
+            checksum += voxels.insert(id);
+            checksum += voxels.contains(PointId(id.x + 1, id.y));
+            checksum += voxels.contains(PointId(id.x, id.y + 1));
+            checksum += voxels.contains(PointId(id.x - 1, id.y));
+            checksum += voxels.contains(PointId(id.x, id.y - 1));
+            lookups += 5;
+
+            for (std::uint32_t c = 0; c < 4; ++c)
+            {
+                PointId corner(id.x + (c & 1), id.y + (c >> 1));
+                auto entry = points.find(corner);
+                if (entry == invalidUint())
+                {
+                    points.insert(corner, next++);
+                    lookups += 1;
+                }
+                checksum += entry;
+                lookups += 1;
+            }
+        }
+
+        sample.nsPerLookup = std::min(sample.nsPerLookup,
+            elapsedNs(start) / lookups);
+        sample.lookups = lookups;
+    }
+
+    std::size_t numPoints =
+        static_cast<std::size_t>(gridSize + 1) * (gridSize + 1);
+    std::size_t numVoxels = static_cast<std::size_t>(gridSize) * gridSize;
+    sample.bytes = (dense) ?
+        numPoints * sizeof(std::uint32_t) + numVoxels / 8 :
+        hashBytes(points.size(), 2 * sizeof(std::uint32_t)) +
+        hashBytes(voxels.size(), sizeof(std::uint32_t) + 1);
+
+    // Keeps the lookups from being optimised away.
+    if (checksum == 1)
+    {
+        sample.lookups += 1;
+    }
+
+    return sample;
+}
+
+std::vector<CacheSample> sweepGridCaches(std::size_t repetitions)
+{
+    std::vector<CacheSample> samples;
+    for (std::uint32_t gridSize : { 64u, 128u, 256u, 512u, 1024u })
+    {
+        auto walk = makeWalk(gridSize);
+        samples.push_back(runSweep(gridSize, true, walk, repetitions));
+        samples.push_back(runSweep(gridSize, false, walk, repetitions));
+    }
+
+    return samples;
+}
+
+void writeCacheSweep(std::ostream& out,
+    std::vector<CacheSample> const& samples)
+{
+    out << "  \"grid_caches\": [\n";
+    for (std::size_t i = 0; i < samples.size(); ++i)
+    {
+        auto const& s = samples[i];
+        out << "    { \"grid_size\": " << s.gridSize <<
+            ", \"storage\": \"" << ((s.dense) ? "dense" : "hash") << "\"" <<
+            ", \"lookups\": " << s.lookups <<
+            ", \"reset_ns\": " << s.resetNs <<
+            ", \"ns_per_lookup\": " << s.nsPerLookup <<
+            ", \"bytes\": " << s.bytes << " }" <<
+            ((i + 1 < samples.size()) ? ",\n" : "\n");
+    }
+    out << "  ],\n";
+}
@@ -0,0 +1,28 @@
+#ifndef ATHENA_BENCH_CACHE_SWEEP_HPP
+#define ATHENA_BENCH_CACHE_SWEEP_HPP
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Lookup cost of the cross-section grid caches for one grid size, with the
+// caches forced into either their dense or their hashed storage.
+struct CacheSample
+{
+    std::uint32_t gridSize;
+    bool dense;
+    std::size_t lookups;
+
+    // Best of the repetitions, in nanoseconds.
+    double resetNs;
+    double nsPerLookup;
+    std::size_t bytes;
+};
+
+std::vector<CacheSample> sweepGridCaches(std::size_t repetitions);
+void writeCacheSweep(std::ostream& out,
+    std::vector<CacheSample> const& samples);
+
+#endif
@@ -0,0 +1,405 @@
+#include "athena/Athena.hpp"
+#include "athena/models/Models.hpp"
+#include "CacheSweep.hpp"
+
+#include <atlas/core/Log.hpp>
+#include <atlas/core/Timer.hpp>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using athena::polygonizer::PolygonizerStats;
+using athena::polygonizer::SectionStats;
+
+using Samples = std::vector<float>;
+using Stages = std::vector<std::pair<std::string, Samples>>;
+
+struct Run
+{
+    std::string model;
+    std::string method;
+    std::string resolution;
+
+    // Zero when the platform can't measure the peak of a single run.
+    std::size_t peakResidentBytes;
+    Samples evaluationRates;
+    Samples cellRates;
+    Samples totals;
+    Stages stages;
+
+    // The counters are deterministic, so only the last repetition is kept.
+    PolygonizerStats last;
+};
+
+std::size_t getPeakResidentBytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+        sizeof(counters)))
+    {
+        return counters.PeakWorkingSetSize;
+    }
+
+    return 0;
+#else
+    // Linux reports the peak in kilobytes.
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+        return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+    }
+
+    return 0;
+#endif
+}
+
+// Only Linux lets the peak be reset, so elsewhere runs don't report their
+// own and this returns false. Freed heap is handed back first, otherwise
+// it would still count towards the next run.
+bool resetRunPeakResidentBytes()
+{
+#if defined(__linux__)
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    clearRefs.close();
+    return !clearRefs.fail();
+#else
+    return false;
+#endif
+}
+
+// Peak since the last reset, in bytes.
+std::size_t getRunPeakResidentBytes()
+{
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+        {
+            return static_cast<std::size_t>(
+                std::stoull(line.substr(6))) * 1024;
+        }
+    }
+#endif
+
+    return 0;
+}
+
+// Nearest-rank percentile of an already sorted set of samples.
+float percentile(Samples const& sorted, float p)
+{
+    auto rank = static_cast<std::size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::max(rank, std::size_t(1)) - 1];
+}
+
+void writeSummary(std::ostream& out, Samples samples)
+{
+    std::sort(samples.begin(), samples.end());
+    out << "{ \"min\": " << samples.front() <<
+        ", \"median\": " << percentile(samples, 0.5f) <<
+        ", \"p95\": " << percentile(samples, 0.95f) << " }";
+}
+
+void writeSection(std::ostream& out, SectionStats const& section)
+{
+    out << "{ \"lattice\": " << section.lattice <<
+        ", \"contour\": " << section.contour <<
+        ", \"resize\": " << section.resize <<
+        ", \"field_samples\": " << section.fieldSamples <<
+        ", \"point_cache_hits\": " << section.pointCacheHits <<
+        ", \"voxels_marched\": " << section.voxelsMarched <<
+        ", \"root_evaluations\": " << section.rootEvaluations <<
+        ", \"surface_evaluations\": " << section.surfaceEvaluations <<
+        ", \"contours\": " << section.contours << " }";
+}
+
+void writeRun(std::ostream& out, Run const& run)
+{
+    out << "    {\n";
+    out << "      \"model\": \"" << run.model << "\",\n";
+    out << "      \"method\": \"" << run.method << "\",\n";
+    out << "      \"resolution\": \"" << run.resolution << "\",\n";
+    out << "      \"vertices\": " << run.last.vertices << ",\n";
+    out << "      \"field_evaluations\": " << run.last.fieldEvaluations <<
+        ",\n";
+    if (run.peakResidentBytes > 0)
+    {
+        out << "      \"peak_rss_bytes\": " << run.peakResidentBytes <<
+            ",\n";
+    }
+    out << "      \"evaluations_per_second\": ";
+    writeSummary(out, run.evaluationRates);
+    out << ",\n";
+    if (!run.cellRates.empty())
+    {
+        out << "      \"cells_per_second\": ";
+        writeSummary(out, run.cellRates);
+        out << ",\n";
+    }
+    out << "      \"stages\": {\n";
+    for (auto& stage : run.stages)
+    {
+        out << "        \"" << stage.first << "\": ";
+        writeSummary(out, stage.second);
+        out << ",\n";
+    }
+    out << "        \"total\": ";
+    writeSummary(out, run.totals);
+    out << "\n      },\n";
+    out << "      \"sections\": [";
+    for (std::size_t i = 0; i < run.last.sections.size(); ++i)
+    {
+        out << ((i == 0) ? "\n        " : ",\n        ");
+        writeSection(out, run.last.sections[i]);
+    }
+    out << ((run.last.sections.empty()) ? "]\n" : "\n      ]\n");
+    out << "    }";
+}
+
+void addSample(Run& run, PolygonizerStats const& stats)
+{
+    for (auto& stage : stats.stages)
+    {
+        auto it = std::find_if(run.stages.begin(), run.stages.end(),
+            [&stage](std::pair<std::string, Samples> const& s)
+        {
+            return s.first == stage.name;
+        });
+
+        if (it == run.stages.end())
+        {
+            run.stages.emplace_back(stage.name, Samples());
+            it = run.stages.end() - 1;
+        }
+
+        it->second.push_back(stage.time);
+    }
+
+    run.totals.push_back(stats.total);
+    run.evaluationRates.push_back((stats.total > 0.0f) ?
+        stats.fieldEvaluations / stats.total : 0.0f);
+    if (stats.cells > 0 && stats.stage("cells") > 0.0f)
+    {
+        run.cellRates.push_back(stats.cells / stats.stage("cells"));
+    }
+    run.last = stats;
+}
+
+// Each call to polygonize has to build a fresh polygonizer, otherwise the
+// cached field samples would be reused. The catalog models share one tree
+// for the whole process, so its pruned sub-trees have to be dropped too.
+template <typename Polygonize>
+Run benchPolygonizer(std::string const& method, Polygonize const& polygonize,
+    std::size_t repetitions)
+{
+    Run run;
+    run.method = method;
+
+    bool measurePeak = resetRunPeakResidentBytes();
+    for (std::size_t i = 0; i < repetitions; ++i)
+    {
+        addSample(run, polygonize());
+    }
+
+    run.peakResidentBytes = (measurePeak) ? getRunPeakResidentBytes() : 0;
+    return run;
+}
+
+// Checks that culling the leaves of a tree doesn't change its field, over a
+// grid that reaches past the tree box on every side. The cylinder and cone
+// aren't in the catalog, but their boxes are the ones most likely to be
+// wrong, so they are checked as well.
+bool checkCulling(std::ostream& out)
+{
+    using athena::tree::TreePointer;
+    using atlas::math::Point;
+    namespace models = athena::models;
+
+    std::vector<std::pair<std::string, TreePointer>> trees =
+    {
+        { "sphere", models::makeSphereTree() },
+        { "peanut", models::makePeanutTree() },
+        { "cylinder", models::makeCylinderTree() },
+        { "cone", models::makeConeTree() },
+        { "torus", models::makeTorusTree() },
+        { "chain", models::makeChainTree() }
+    };
+
+    // Filters are non-zero up to a distance of one, so go a bit past that.
+    const std::size_t resolution = 24;
+    const float margin = 2.0f;
+    const float tolerance = 1.0e-6f;
+
+    bool passed = true;
+    out << "  \"culling_checks\": [\n";
+    for (std::size_t t = 0; t < trees.size(); ++t)
+    {
+        auto box = trees[t].second->getTreeBox();
+        Point start = box.pMin - margin;
+        Point delta = (box.pMax - box.pMin + 2.0f * margin) /
+            static_cast<float>(resolution - 1);
+
+        std::vector<Point> points;
+        for (std::size_t x = 0; x < resolution; ++x)
+        {
+            for (std::size_t y = 0; y < resolution; ++y)
+            {
+                for (std::size_t z = 0; z < resolution; ++z)
+                {
+                    points.push_back(start + Point(x * delta.x, y * delta.y,
+                        z * delta.z));
+                }
+            }
+        }
+
+        float error = trees[t].second->maxCullingError(points);
+        if (error > tolerance)
+        {
+            ERROR_LOG_V("Culling changes the field of %s by %f",
+                trees[t].first.c_str(), error);
+            passed = false;
+        }
+
+        out << "    { \"model\": \"" << trees[t].first <<
+            "\", \"points\": " << points.size() <<
+            ", \"max_error\": " << error << " }" <<
+            ((t + 1 < trees.size()) ? ",\n" : "\n");
+    }
+    out << "  ],\n";
+
+    return passed;
+}
+
+// Usage: athena_bench [repetitions] [output file]
+int main(int argc, char** argv)
+{
+    using athena::models::ModelResolution;
+
+    std::size_t repetitions = 5;
+    std::string outputFile = "bench.json";
+    if (argc > 1)
+    {
+        repetitions = std::max(std::atoi(argv[1]), 1);
+    }
+
+    if (argc > 2)
+    {
+        outputFile = argv[2];
+    }
+
+    std::vector<std::pair<ModelResolution, std::string>> resolutions =
+    {
+        { ModelResolution::Low, "low" },
+        { ModelResolution::Mid, "mid" },
+        { ModelResolution::High, "high" }
+    };
+
+    INFO_LOG_V("Athena benchmark %s", ATHENA_VERSION_STRING);
+
+    std::stringstream culling;
+    bool cullingPassed = checkCulling(culling);
+
+    // Resetting the peak of a run resets the process-wide one as well, so
+    // keep the largest one seen.
+    std::size_t peakResidentBytes = getPeakResidentBytes();
+    std::vector<Run> runs;
+    for (auto& entry : athena::models::getModelCatalog())
+    {
+        for (auto& res : resolutions)
+        {
+            INFO_LOG_V("Benchmarking %s at %s resolution",
+                entry.name.c_str(), res.second.c_str());
+
+            auto resolution = res.first;
+            runs.push_back(benchPolygonizer("bsoid", [&entry, resolution]()
+            {
+                auto soid = entry.makeSoid(resolution);
+                soid.tree()->clearSubTreeCache();
+                return soid.polygonize();
+            }, repetitions));
+            runs.push_back(benchPolygonizer("bsoid_streaming",
+                [&entry, resolution]()
+            {
+                // The strips are dropped, only the time to make them counts.
+                auto soid = entry.makeSoid(resolution);
+                soid.tree()->clearSubTreeCache();
+                return soid.polygonizeStreaming(
+                    [](atlas::utils::Mesh const&) { });
+            }, repetitions));
+            runs.push_back(benchPolygonizer("bsoid_pipelined",
+                [&entry, resolution]()
+            {
+                auto soid = entry.makeSoid(resolution);
+                soid.tree()->clearSubTreeCache();
+                soid.setPipelined(true);
+                return soid.polygonize();
+            }, repetitions));
+            runs.push_back(benchPolygonizer("marching_cubes",
+                [&entry, resolution]()
+            {
+                auto mc = entry.makeMC(resolution);
+                return mc.polygonize();
+            }, repetitions));
+            for (std::size_t i = runs.size() - 4; i < runs.size(); ++i)
+            {
+                runs[i].model = entry.name;
+                runs[i].resolution = res.second;
+                peakResidentBytes = std::max(peakResidentBytes,
+                    runs[i].peakResidentBytes);
+            }
+        }
+    }
+
+    INFO_LOG("Sweeping the grid caches");
+    auto cacheSamples = sweepGridCaches(repetitions);
+    peakResidentBytes = std::max(peakResidentBytes, getPeakResidentBytes());
+
+    std::fstream file(outputFile, std::fstream::out);
+    file << "{\n";
+    file << "  \"version\": \"" << ATHENA_VERSION_STRING << "\",\n";
+#if defined(ATHENA_PARALLEL)
+    file << "  \"parallel\": true,\n";
+#else
+    file << "  \"parallel\": false,\n";
+#endif
+    file << "  \"repetitions\": " << repetitions << ",\n";
+    file << "  \"peak_rss_bytes\": " << peakResidentBytes << ",\n";
+    writeCacheSweep(file, cacheSamples);
+    file << culling.str();
+    file << "  \"runs\": [\n";
+    for (std::size_t i = 0; i < runs.size(); ++i)
+    {
+        writeRun(file, runs[i]);
+        file << ((i + 1 < runs.size()) ? ",\n" : "\n");
+    }
+    file << "  ]\n";
+    file << "}\n";
+    file.close();
+
+    INFO_LOG_V("Results written to %s", outputFile.c_str());
+
+    return (cullingPassed) ? 0 : 1;
+}
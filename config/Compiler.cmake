@@ -26,6 +26,11 @@ if (ATHENA_PARALLEL)
     add_definitions(-DATHENA_PARALLEL)
 endif()
 
+# Same for the polygonizer stats, which are compiled out otherwise.
+if (ATHENA_STATS)
+    add_definitions(-DATHENA_STATS_ENABLED)
+endif()
+
 # Now set the compiler flags, notice that Windows requires a different syntax
 # for flags than Linux does, so lets handle that one first.
 if (WIN32)
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "ImplicitField.hpp"
+#include "Tape.hpp"
 
 namespace athena
 {
@@ -54,6 +55,14 @@ namespace athena
                 return { seed };
             }
 
+            bool compile(Tape& tape) const override
+            {
+                float c = mRadius / mHeight;
+                tape.pushPrimitive(TapeOp::Cone,
+                    { c * c, mCentre.x, mCentre.y });
+                return true;
+            }
+
         private:
             float sdf(atlas::math::Point const& p) const override
             {
@@ -71,6 +80,33 @@ namespace athena
 
             }
 
+            void sdfBatch(PointBatch const& points,
+                std::vector<float>& values) const override
+            {
+                const float c = mRadius / mHeight;
+                const float c2 = c * c;
+                float const* x = points.x.data();
+                float const* y = points.y.data();
+                float const* z = points.z.data();
+                float* out = values.data();
+                for (std::size_t i = 0; i < points.size(); ++i)
+                {
+                    float denom = x[i] * x[i] + z[i] * z[i];
+                    out[i] = (denom / c2) - (y[i] * y[i]);
+                }
+            }
+
+            void sdgBatch(PointBatch const& points,
+                NormalBatch& grads) const override
+            {
+                for (std::size_t i = 0; i < points.size(); ++i)
+                {
+                    grads.x[i] = 2.0f * (points.x[i] - mCentre.x);
+                    grads.y[i] = 0.0f;
+                    grads.z[i] = -2.0f * (points.z[i] - mCentre.y);
+                }
+            }
+
             atlas::utils::BBox box() const override
             {
                 using atlas::utils::BBox;
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "ImplicitField.hpp"
+#include "Tape.hpp"
 
 namespace athena
 {
@@ -64,6 +65,13 @@ namespace athena
                 return { seed, seed2 };
             }
 
+            bool compile(Tape& tape) const override
+            {
+                tape.pushPrimitive(TapeOp::Cylinder,
+                    { mCentre.x, mCentre.y, mRadius });
+                return true;
+            }
+
         private:
             float sdf(atlas::math::Point const& p) const override
             {
@@ -76,6 +84,32 @@ namespace athena
                 return { 2.0f * g.x, 0.0f, 2.0f * g.y };
             }
 
+            void sdfBatch(PointBatch const& points,
+                std::vector<float>& values) const override
+            {
+                const float cx = mCentre.x, cz = mCentre.y;
+                float const* x = points.x.data();
+                float const* z = points.z.data();
+                float* out = values.data();
+                for (std::size_t i = 0; i < points.size(); ++i)
+                {
+                    float dx = x[i] - cx;
+                    float dz = z[i] - cz;
+                    out[i] = std::sqrt(dx * dx + dz * dz) - mRadius;
+                }
+            }
+
+            void sdgBatch(PointBatch const& points,
+                NormalBatch& grads) const override
+            {
+                for (std::size_t i = 0; i < points.size(); ++i)
+                {
+                    grads.x[i] = 2.0f * (points.x[i] - mCentre.x);
+                    grads.y[i] = 0.0f;
+                    grads.z[i] = 2.0f * (points.z[i] - mCentre.y);
+                }
+            }
+
             atlas::utils::BBox box() const override
             {
                 using atlas::utils::BBox;
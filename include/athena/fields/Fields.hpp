@@ -18,6 +18,8 @@ namespace athena
         class Sphere;
         class Torus;
         class Cone;
+        class Tape;
+        class FieldProfiler;
 
         using ImplicitFieldPtr = std::shared_ptr<ImplicitField>;
     }
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 namespace athena
 {
     namespace fields
@@ -48,6 +50,46 @@ namespace athena
             return (A * x4) + (B * x2) - C;
 
         }
+
+        // Batched versions of the filters. These are written with selects
+        // instead of early returns so the loops vectorize, while returning
+        // exactly the same values as the scalar filters.
+        inline void compactFieldBatch(float const* dist, float* out,
+            std::size_t count)
+        {
+            static constexpr float A = -3.0f / 16;
+            static constexpr float B = 5.0f / 8;
+            static constexpr float C = 15.0f / 16.0f;
+            static constexpr float D = 0.5f;
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const float d = dist[i];
+                const float x = d / radius;
+                const float x3 = x * x * x;
+                const float x5 = x3 * x * x;
+                const float f = (A * x5) + (B * x3) - (C * x) + D;
+                out[i] = (d < -radius) ? 1.0f : ((d > radius) ? 0.0f : f);
+            }
+        }
+
+        inline void compactGradientBatch(float const* dist, float* out,
+            std::size_t count)
+        {
+            static constexpr float A = -15.0f / 16;
+            static constexpr float B = 15.0f / 8;
+            static constexpr float C = 15.0f / 16;
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const float d = dist[i];
+                const float x = d / radius;
+                const float x2 = x * x;
+                const float x4 = x2 * x2;
+                const float g = (A * x4) + (B * x2) - C;
+                out[i] = (d < -radius || d > radius) ? 0.0f : g;
+            }
+        }
     }
 }
 
@@ -5,16 +5,26 @@
 
 #include "Fields.hpp"
 #include "Filters.hpp"
+#include "PointBatch.hpp"
 
+#include <atlas/core/Macros.hpp>
 #include <atlas/math/Math.hpp>
 #include <atlas/utils/BBox.hpp>
 
+#include <cmath>
 #include <vector>
 
 namespace athena
 {
     namespace fields
     {
+        // The field value and gradient at a single point.
+        struct FieldSample
+        {
+            float value;
+            atlas::math::Normal gradient;
+        };
+
         class ImplicitField
         {
         public:
@@ -40,19 +50,96 @@ namespace athena
                 return compactGradient(sdf(p)) * sdg(p);
             }
 
+            // Computes eval and grad together so the distance is only
+            // computed once.
+            virtual FieldSample evalWithGradient(
+                atlas::math::Point const& p) const
+            {
+                float d = sdf(p);
+                return { compactField(d), compactGradient(d) * sdg(p) };
+            }
+
             virtual atlas::math::Normal naturalGradient(
                 atlas::math::Point const& p) const
             {
                 return sdg(p);
             }
 
+            virtual void evalBatch(PointBatch const& points,
+                std::vector<float>& values) const
+            {
+                values.resize(points.size());
+                sdfBatch(points, values);
+                compactFieldBatch(values.data(), values.data(), values.size());
+            }
+
+            virtual void gradBatch(PointBatch const& points,
+                NormalBatch& grads) const
+            {
+                std::vector<float> scale(points.size());
+                sdfBatch(points, scale);
+                compactGradientBatch(scale.data(), scale.data(), scale.size());
+
+                grads.resize(points.size());
+                sdgBatch(points, grads);
+                for (std::size_t i = 0; i < scale.size(); ++i)
+                {
+                    grads.x[i] *= scale[i];
+                    grads.y[i] *= scale[i];
+                    grads.z[i] *= scale[i];
+                }
+            }
+
+            virtual void naturalGradientBatch(PointBatch const& points,
+                NormalBatch& grads) const
+            {
+                grads.resize(points.size());
+                sdgBatch(points, grads);
+            }
+
             virtual std::vector<atlas::math::Point> getSeeds(
                 atlas::math::Normal const& u) const = 0;
 
+            // True if eval is zero everywhere outside of getBBox. Only these
+            // fields can be skipped when a point misses their box.
+            virtual bool hasCompactSupport() const
+            {
+                return false;
+            }
+
+            // Writes the field onto the tape. Fields that return false are
+            // evaluated through their virtual functions instead.
+            virtual bool compile(Tape& tape) const
+            {
+                UNUSED(tape);
+                return false;
+            }
+
         protected:
             virtual float sdf(atlas::math::Point const& p) const = 0;
             virtual atlas::math::Normal sdg(atlas::math::Point const& p) const = 0;
             virtual atlas::utils::BBox box() const = 0;
+
+            // The batched kernels write into arrays already sized to the
+            // number of points. Fields that don't provide their own kernels
+            // fall back to one call per point.
+            virtual void sdfBatch(PointBatch const& points,
+                std::vector<float>& values) const
+            {
+                for (std::size_t i = 0; i < points.size(); ++i)
+                {
+                    values[i] = sdf(points[i]);
+                }
+            }
+
+            virtual void sdgBatch(PointBatch const& points,
+                NormalBatch& grads) const
+            {
+                for (std::size_t i = 0; i < points.size(); ++i)
+                {
+                    grads.set(i, sdg(points[i]));
+                }
+            }
         };
     }
 }
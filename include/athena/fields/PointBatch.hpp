@@ -0,0 +1,71 @@
+#ifndef ATHENA_INCLUDE_ATHENA_FIELDS_POINT_BATCH_HPP
+#define ATHENA_INCLUDE_ATHENA_FIELDS_POINT_BATCH_HPP
+
+#pragma once
+
+#include <atlas/math/Math.hpp>
+
+#include <vector>
+
+namespace athena
+{
+    namespace fields
+    {
+        // Structure-of-arrays list of points, so the batched field kernels
+        // can run over each coordinate as a contiguous stream.
+        struct PointBatch
+        {
+            PointBatch() = default;
+
+            PointBatch(std::size_t size) :
+                x(size),
+                y(size),
+                z(size)
+            { }
+
+            std::size_t size() const
+            {
+                return x.size();
+            }
+
+            void resize(std::size_t size)
+            {
+                x.resize(size);
+                y.resize(size);
+                z.resize(size);
+            }
+
+            void clear()
+            {
+                x.clear();
+                y.clear();
+                z.clear();
+            }
+
+            void push_back(atlas::math::Point const& p)
+            {
+                x.push_back(p.x);
+                y.push_back(p.y);
+                z.push_back(p.z);
+            }
+
+            void set(std::size_t i, atlas::math::Point const& p)
+            {
+                x[i] = p.x;
+                y[i] = p.y;
+                z[i] = p.z;
+            }
+
+            atlas::math::Point operator[](std::size_t i) const
+            {
+                return { x[i], y[i], z[i] };
+            }
+
+            std::vector<float> x, y, z;
+        };
+
+        using NormalBatch = PointBatch;
+    }
+}
+
+#endif
@@ -0,0 +1,288 @@
+#ifndef ATHENA_INCLUDE_ATHENA_FIELDS_PROFILED_FIELD_HPP
+#define ATHENA_INCLUDE_ATHENA_FIELDS_PROFILED_FIELD_HPP
+
+#pragma once
+
+#include "Fields.hpp"
+#include "ImplicitField.hpp"
+
+#if defined(ATHENA_PARALLEL)
+#include <tbb/enumerable_thread_specific.h>
+#endif
+
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace athena
+{
+    namespace fields
+    {
+        using ProfileClock = std::chrono::steady_clock;
+
+        struct ProfileCounters
+        {
+            // Gradient-only calls don't produce a value, so only the
+            // samples can be checked against the support.
+            std::size_t calls = 0;
+            std::size_t samples = 0;
+            std::size_t outside = 0;
+            double seconds = 0.0;
+        };
+
+        // The counters for a single node of a tree. Every thread records
+        // into its own copy, so the hot path never contends.
+        class FieldProfile
+        {
+        public:
+            FieldProfile(std::string const& name) :
+                mName(name)
+            { }
+
+            std::string const& name() const
+            {
+                return mName;
+            }
+
+            void recordCalls(std::size_t num, ProfileClock::time_point start)
+            {
+                auto& counters = local();
+                counters.calls += num;
+                counters.seconds += elapsed(start);
+            }
+
+            void recordValue(float value, ProfileClock::time_point start)
+            {
+                recordValues(&value, 1, start);
+            }
+
+            void recordValues(float const* values, std::size_t num,
+                ProfileClock::time_point start)
+            {
+                auto& counters = local();
+                counters.seconds += elapsed(start);
+                counters.calls += num;
+                counters.samples += num;
+                for (std::size_t i = 0; i < num; ++i)
+                {
+                    // The compact filter saturates outside the support.
+                    if (values[i] == 0.0f || values[i] == 1.0f)
+                    {
+                        counters.outside += 1;
+                    }
+                }
+            }
+
+            ProfileCounters combine() const
+            {
+#if defined(ATHENA_PARALLEL)
+                ProfileCounters result;
+                for (auto& counters : mCounters)
+                {
+                    result.calls += counters.calls;
+                    result.samples += counters.samples;
+                    result.outside += counters.outside;
+                    result.seconds += counters.seconds;
+                }
+
+                return result;
+#else
+                return mCounters;
+#endif
+            }
+
+            void clear()
+            {
+#if defined(ATHENA_PARALLEL)
+                mCounters.clear();
+#else
+                mCounters = ProfileCounters();
+#endif
+            }
+
+        private:
+            static double elapsed(ProfileClock::time_point start)
+            {
+                return std::chrono::duration<double>(
+                    ProfileClock::now() - start).count();
+            }
+
+            ProfileCounters& local()
+            {
+#if defined(ATHENA_PARALLEL)
+                return mCounters.local();
+#else
+                return mCounters;
+#endif
+            }
+
+            std::string mName;
+#if defined(ATHENA_PARALLEL)
+            tbb::enumerable_thread_specific<ProfileCounters> mCounters;
+#else
+            ProfileCounters mCounters;
+#endif
+        };
+
+        using FieldProfilePtr = std::shared_ptr<FieldProfile>;
+
+        class FieldProfiler
+        {
+        public:
+            FieldProfilePtr addProfile(std::string const& name)
+            {
+                mProfiles.push_back(std::make_shared<FieldProfile>(name));
+                return mProfiles.back();
+            }
+
+            void clear()
+            {
+                for (auto& profile : mProfiles)
+                {
+                    profile->clear();
+                }
+            }
+
+            // Times are inclusive, so an operator also accounts for the
+            // time spent in its children.
+            std::string report() const
+            {
+                std::stringstream out;
+                out << "Field profile:\n";
+                for (auto& profile : mProfiles)
+                {
+                    auto counters = profile->combine();
+                    float outside = (counters.samples > 0) ?
+                        100.0f * counters.outside / counters.samples : 0.0f;
+                    double perCall = (counters.calls > 0) ?
+                        1.0e9 * counters.seconds / counters.calls : 0.0;
+
+                    out << "  " << profile->name() << ": " <<
+                        counters.calls << " calls, " <<
+                        std::fixed << std::setprecision(1) << outside <<
+                        "% outside support, " <<
+                        std::setprecision(4) << counters.seconds <<
+                        " seconds (" << std::setprecision(1) << perCall <<
+                        " ns/call)\n";
+                    out.unsetf(std::ios_base::floatfield);
+                }
+
+                return out.str();
+            }
+
+        private:
+            std::vector<FieldProfilePtr> mProfiles;
+        };
+
+        // Forwards everything to the wrapped field and records each call.
+        // Profiled fields don't compile onto the tape, so a profiled tree is
+        // evaluated through the virtual interface.
+        class ProfiledField : public ImplicitField
+        {
+        public:
+            ProfiledField(ImplicitFieldPtr const& field,
+                FieldProfilePtr const& profile) :
+                mField(field),
+                mProfile(profile)
+            { }
+
+            ~ProfiledField() = default;
+
+            atlas::utils::BBox getBBox() const override
+            {
+                return mField->getBBox();
+            }
+
+            float eval(atlas::math::Point const& p) const override
+            {
+                auto start = ProfileClock::now();
+                float value = mField->eval(p);
+                mProfile->recordValue(value, start);
+                return value;
+            }
+
+            atlas::math::Normal grad(atlas::math::Point const& p) const override
+            {
+                auto start = ProfileClock::now();
+                auto gradient = mField->grad(p);
+                mProfile->recordCalls(1, start);
+                return gradient;
+            }
+
+            FieldSample evalWithGradient(
+                atlas::math::Point const& p) const override
+            {
+                auto start = ProfileClock::now();
+                auto sample = mField->evalWithGradient(p);
+                mProfile->recordValue(sample.value, start);
+                return sample;
+            }
+
+            atlas::math::Normal naturalGradient(
+                atlas::math::Point const& p) const override
+            {
+                return mField->naturalGradient(p);
+            }
+
+            void evalBatch(PointBatch const& points,
+                std::vector<float>& values) const override
+            {
+                auto start = ProfileClock::now();
+                mField->evalBatch(points, values);
+                mProfile->recordValues(values.data(), values.size(), start);
+            }
+
+            void gradBatch(PointBatch const& points,
+                NormalBatch& grads) const override
+            {
+                auto start = ProfileClock::now();
+                mField->gradBatch(points, grads);
+                mProfile->recordCalls(points.size(), start);
+            }
+
+            void naturalGradientBatch(PointBatch const& points,
+                NormalBatch& grads) const override
+            {
+                mField->naturalGradientBatch(points, grads);
+            }
+
+            std::vector<atlas::math::Point> getSeeds(
+                atlas::math::Normal const& u) const override
+            {
+                return mField->getSeeds(u);
+            }
+
+            bool hasCompactSupport() const override
+            {
+                return mField->hasCompactSupport();
+            }
+
+        protected:
+            // Every public entry point is forwarded, so these are never
+            // reached.
+            float sdf(atlas::math::Point const& p) const override
+            {
+                return mField->eval(p);
+            }
+
+            atlas::math::Normal sdg(atlas::math::Point const& p) const override
+            {
+                return mField->grad(p);
+            }
+
+            atlas::utils::BBox box() const override
+            {
+                return mField->getBBox();
+            }
+
+        private:
+            ImplicitFieldPtr mField;
+            FieldProfilePtr mProfile;
+        };
+    }
+}
+
+#endif
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "ImplicitField.hpp"
+#include "Tape.hpp"
 
 namespace athena
 {
@@ -56,6 +57,18 @@ namespace athena
                 return { seed };
             }
 
+            bool hasCompactSupport() const override
+            {
+                return true;
+            }
+
+            bool compile(Tape& tape) const override
+            {
+                tape.pushPrimitive(TapeOp::Sphere,
+                    { mCentre.x, mCentre.y, mCentre.z, mRadius });
+                return true;
+            }
+
         private:
             float sdf(atlas::math::Point const& p) const override
             {
@@ -67,6 +80,34 @@ namespace athena
                 return 2.0f * (p - mCentre);
             }
 
+            void sdfBatch(PointBatch const& points,
+                std::vector<float>& values) const override
+            {
+                const float cx = mCentre.x, cy = mCentre.y, cz = mCentre.z;
+                float const* x = points.x.data();
+                float const* y = points.y.data();
+                float const* z = points.z.data();
+                float* out = values.data();
+                for (std::size_t i = 0; i < points.size(); ++i)
+                {
+                    float dx = x[i] - cx;
+                    float dy = y[i] - cy;
+                    float dz = z[i] - cz;
+                    out[i] = std::sqrt(dx * dx + dy * dy + dz * dz) - mRadius;
+                }
+            }
+
+            void sdgBatch(PointBatch const& points,
+                NormalBatch& grads) const override
+            {
+                for (std::size_t i = 0; i < points.size(); ++i)
+                {
+                    grads.x[i] = 2.0f * (points.x[i] - mCentre.x);
+                    grads.y[i] = 2.0f * (points.y[i] - mCentre.y);
+                    grads.z[i] = 2.0f * (points.z[i] - mCentre.z);
+                }
+            }
+
             atlas::utils::BBox box() const override
             {
                 using atlas::utils::BBox;
@@ -0,0 +1,503 @@
+#ifndef ATHENA_INCLUDE_ATHENA_FIELDS_TAPE_HPP
+#define ATHENA_INCLUDE_ATHENA_FIELDS_TAPE_HPP
+
+#pragma once
+
+#include "ImplicitField.hpp"
+
+#include <atlas/core/Constants.hpp>
+#include <atlas/math/Math.hpp>
+
+#include <cinttypes>
+#include <initializer_list>
+#include <vector>
+
+namespace athena
+{
+    namespace fields
+    {
+        enum class TapeOp : std::uint8_t
+        {
+            Sphere = 0,
+            Torus,
+            Cone,
+            Cylinder,
+            Field,
+            Blend,
+            Union,
+            Intersection,
+            Add,
+            Max,
+            Min
+        };
+
+        struct TapeInstruction
+        {
+            TapeOp op;
+            std::uint32_t index;
+        };
+
+        // The deepest operator nesting that the interpreter can handle.
+        // Trees that go beyond this aren't compiled.
+        constexpr std::size_t maxTapeDepth = 64;
+
+        // A flattened version of a field tree. Each primitive pushes its
+        // value onto a stack, and each operator is turned into an
+        // instruction that pushes the identity for the operator followed by
+        // one combine instruction after each child. This keeps the stack
+        // as deep as the tree (instead of as wide) and all of the
+        // parameters for the primitives packed together in one array.
+        class Tape
+        {
+        public:
+            Tape() :
+                mSource(nullptr),
+                mDepth(0),
+                mMaxDepth(0),
+                mFlat(false)
+            { }
+
+            void clear()
+            {
+                mInstructions.clear();
+                mSources.clear();
+                mParams.clear();
+                mFields.clear();
+                mSource = nullptr;
+                mDepth = 0;
+                mMaxDepth = 0;
+                mFlat = false;
+            }
+
+            bool empty() const
+            {
+                return mInstructions.empty();
+            }
+
+            std::size_t size() const
+            {
+                return mInstructions.size();
+            }
+
+            bool valid() const
+            {
+                return !empty() && mMaxDepth <= maxTapeDepth;
+            }
+
+            // A flat tape is a single blend or union of leaves, which can be
+            // evaluated from just the leaves that are active.
+            bool isFlat() const
+            {
+                return mFlat;
+            }
+
+            // Leaves are the primitives and fallback fields, which are the
+            // only instructions that evaluate anything.
+            bool isLeaf(std::size_t i) const
+            {
+                return isLeafOp(mInstructions[i].op);
+            }
+
+            // The field that generated the given instruction, or null for
+            // operators.
+            ImplicitField const* getSource(std::size_t i) const
+            {
+                return mSources[i];
+            }
+
+            // Fields that don't know how to write themselves onto the tape
+            // are called through their virtual interface instead.
+            void compile(ImplicitField const* field)
+            {
+                auto parent = mSource;
+                mSource = field;
+                if (!field->compile(*this))
+                {
+                    emit(TapeOp::Field,
+                        static_cast<std::uint32_t>(mFields.size()));
+                    mFields.push_back(field);
+                    push();
+                }
+                mSource = parent;
+
+                if (!parent)
+                {
+                    mFlat = checkFlat();
+                }
+            }
+
+            void pushPrimitive(TapeOp op, std::initializer_list<float> params)
+            {
+                emit(op, static_cast<std::uint32_t>(mParams.size()));
+                mParams.insert(mParams.end(), params.begin(), params.end());
+                push();
+            }
+
+            void pushOperator(TapeOp op,
+                std::vector<ImplicitFieldPtr> const& children)
+            {
+                TapeOp combine = TapeOp::Add;
+                switch (op)
+                {
+                case TapeOp::Union:
+                    combine = TapeOp::Max;
+                    break;
+
+                case TapeOp::Intersection:
+                    combine = TapeOp::Min;
+                    break;
+
+                default:
+                    break;
+                }
+
+                emit(op, 0);
+                push();
+                for (auto& child : children)
+                {
+                    compile(child.get());
+                    emit(combine, 0);
+                    --mDepth;
+                }
+            }
+
+            float eval(atlas::math::Point const& p) const
+            {
+                return eval(p, nullptr, 0);
+            }
+
+            // Evaluates the tape with only the given leaves (as sorted
+            // instruction indices). The remaining leaves are taken to be
+            // outside of their support, so they contribute nothing. Passing
+            // null evaluates every leaf.
+            float eval(atlas::math::Point const& p, std::uint32_t const* active,
+                std::size_t numActive) const
+            {
+                if (active && mFlat)
+                {
+                    float value = identity(mInstructions[0].op);
+                    TapeOp combine = mInstructions[2].op;
+                    for (std::size_t i = 0; i < numActive; ++i)
+                    {
+                        value = apply(combine, value,
+                            leafValue(mInstructions[active[i]], p));
+                    }
+
+                    return value;
+                }
+
+                float stack[maxTapeDepth];
+                std::size_t top = 0;
+                std::size_t next = 0;
+
+                for (std::size_t i = 0; i < mInstructions.size(); ++i)
+                {
+                    auto const& inst = mInstructions[i];
+                    if (isLeafOp(inst.op))
+                    {
+                        if (active && (next == numActive || active[next] != i))
+                        {
+                            stack[top++] = 0.0f;
+                            continue;
+                        }
+
+                        next += (active) ? 1 : 0;
+                        stack[top++] = leafValue(inst, p);
+                    }
+                    else if (isCombineOp(inst.op))
+                    {
+                        --top;
+                        stack[top - 1] = apply(inst.op, stack[top - 1],
+                            stack[top]);
+                    }
+                    else
+                    {
+                        stack[top++] = identity(inst.op);
+                    }
+                }
+
+                return stack[0];
+            }
+
+            atlas::math::Normal grad(atlas::math::Point const& p) const
+            {
+                using atlas::math::Normal;
+
+                Normal stack[maxTapeDepth];
+                std::size_t top = 0;
+
+                for (auto const& inst : mInstructions)
+                {
+                    if (isLeafOp(inst.op))
+                    {
+                        stack[top++] = (inst.op == TapeOp::Field) ?
+                            mFields[inst.index]->grad(p) :
+                            compactGradient(sdf(inst.op, param(inst), p)) *
+                            sdg(inst.op, param(inst), p);
+                    }
+                    else if (isCombineOp(inst.op))
+                    {
+                        --top;
+                        stack[top - 1] = apply(inst.op, stack[top - 1],
+                            stack[top]);
+                    }
+                    else
+                    {
+                        stack[top++] = Normal(identity(inst.op));
+                    }
+                }
+
+                return stack[0];
+            }
+
+            FieldSample evalWithGradient(atlas::math::Point const& p) const
+            {
+                return evalWithGradient(p, nullptr, 0);
+            }
+
+            FieldSample evalWithGradient(atlas::math::Point const& p,
+                std::uint32_t const* active, std::size_t numActive) const
+            {
+                using atlas::math::Normal;
+
+                if (active && mFlat)
+                {
+                    float id = identity(mInstructions[0].op);
+                    FieldSample sample = { id, Normal(id) };
+                    TapeOp combine = mInstructions[2].op;
+                    for (std::size_t i = 0; i < numActive; ++i)
+                    {
+                        auto s = leafSample(mInstructions[active[i]], p);
+                        sample.value = apply(combine, sample.value, s.value);
+                        sample.gradient =
+                            apply(combine, sample.gradient, s.gradient);
+                    }
+
+                    return sample;
+                }
+
+                float values[maxTapeDepth];
+                Normal grads[maxTapeDepth];
+                std::size_t top = 0;
+                std::size_t next = 0;
+
+                for (std::size_t i = 0; i < mInstructions.size(); ++i)
+                {
+                    auto const& inst = mInstructions[i];
+                    if (isLeafOp(inst.op))
+                    {
+                        if (active && (next == numActive || active[next] != i))
+                        {
+                            values[top] = 0.0f;
+                            grads[top++] = Normal(0.0f);
+                            continue;
+                        }
+
+                        next += (active) ? 1 : 0;
+                        auto s = leafSample(inst, p);
+                        values[top] = s.value;
+                        grads[top++] = s.gradient;
+                    }
+                    else if (isCombineOp(inst.op))
+                    {
+                        --top;
+                        values[top - 1] = apply(inst.op, values[top - 1],
+                            values[top]);
+                        grads[top - 1] = apply(inst.op, grads[top - 1],
+                            grads[top]);
+                    }
+                    else
+                    {
+                        values[top] = identity(inst.op);
+                        grads[top++] = Normal(identity(inst.op));
+                    }
+                }
+
+                return { values[0], grads[0] };
+            }
+
+        private:
+            static bool isLeafOp(TapeOp op)
+            {
+                return op <= TapeOp::Field;
+            }
+
+            static bool isCombineOp(TapeOp op)
+            {
+                return op >= TapeOp::Add;
+            }
+
+            static float identity(TapeOp op)
+            {
+                return (op == TapeOp::Intersection) ?
+                    atlas::core::infinity() : 0.0f;
+            }
+
+            template <typename T>
+            static T apply(TapeOp op, T const& a, T const& b)
+            {
+                switch (op)
+                {
+                case TapeOp::Max:
+                    return glm::max(a, b);
+
+                case TapeOp::Min:
+                    return glm::min(a, b);
+
+                default:
+                    return a + b;
+                }
+            }
+
+            float const* param(TapeInstruction const& inst) const
+            {
+                return mParams.data() + inst.index;
+            }
+
+            float leafValue(TapeInstruction const& inst,
+                atlas::math::Point const& p) const
+            {
+                if (inst.op == TapeOp::Field)
+                {
+                    return mFields[inst.index]->eval(p);
+                }
+
+                return compactField(sdf(inst.op, param(inst), p));
+            }
+
+            FieldSample leafSample(TapeInstruction const& inst,
+                atlas::math::Point const& p) const
+            {
+                if (inst.op == TapeOp::Field)
+                {
+                    return mFields[inst.index]->evalWithGradient(p);
+                }
+
+                float d = sdf(inst.op, param(inst), p);
+                return { compactField(d),
+                    compactGradient(d) * sdg(inst.op, param(inst), p) };
+            }
+
+            bool checkFlat() const
+            {
+                if (mInstructions.size() < 3 ||
+                    (mInstructions[0].op != TapeOp::Blend &&
+                    mInstructions[0].op != TapeOp::Union))
+                {
+                    return false;
+                }
+
+                for (std::size_t i = 1; i < mInstructions.size(); i += 2)
+                {
+                    if (i + 1 >= mInstructions.size() ||
+                        !isLeafOp(mInstructions[i].op) ||
+                        !isCombineOp(mInstructions[i + 1].op))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            void emit(TapeOp op, std::uint32_t index)
+            {
+                mInstructions.push_back({ op, index });
+                mSources.push_back((isLeafOp(op)) ? mSource : nullptr);
+            }
+
+            void push()
+            {
+                ++mDepth;
+                mMaxDepth = (mDepth > mMaxDepth) ? mDepth : mMaxDepth;
+            }
+
+            // These mirror the sdf and sdg functions of each primitive, so
+            // keep them in sync.
+            static float sdf(TapeOp op, float const* params,
+                atlas::math::Point const& p)
+            {
+                switch (op)
+                {
+                case TapeOp::Sphere:
+                {
+                    float dx = p.x - params[0];
+                    float dy = p.y - params[1];
+                    float dz = p.z - params[2];
+                    return std::sqrt(dx * dx + dy * dy + dz * dz) - params[3];
+                }
+
+                case TapeOp::Torus:
+                {
+                    float dx = p.x - params[0];
+                    float dy = p.y - params[1];
+                    float dz = p.z - params[2];
+                    float root = std::sqrt(dx * dx + dy * dy);
+                    float left = (params[3] - root) * (params[3] - root);
+                    return left + dz * dz - (params[4] * params[4]);
+                }
+
+                case TapeOp::Cone:
+                {
+                    float denom = p.x * p.x + p.z * p.z;
+                    return (denom / params[0]) - (p.y * p.y);
+                }
+
+                case TapeOp::Cylinder:
+                {
+                    float dx = p.x - params[0];
+                    float dz = p.z - params[1];
+                    return std::sqrt(dx * dx + dz * dz) - params[2];
+                }
+
+                default:
+                    return 0.0f;
+                }
+            }
+
+            static atlas::math::Normal sdg(TapeOp op, float const* params,
+                atlas::math::Point const& p)
+            {
+                using atlas::math::Normal;
+
+                switch (op)
+                {
+                case TapeOp::Sphere:
+                    return 2.0f * (p - Normal(params[0], params[1], params[2]));
+
+                case TapeOp::Torus:
+                {
+                    float dx = p.x - params[0];
+                    float dy = p.y - params[1];
+                    float sqrt = std::sqrt(dx * dx + dy * dy);
+                    return Normal(
+                        -2.0f * (params[3] - sqrt) * dx / sqrt,
+                        -2.0f * (params[3] - sqrt) * dy / sqrt,
+                        2.0f * (p.z - params[2]));
+                }
+
+                case TapeOp::Cone:
+                    return Normal(2.0f * (p.x - params[1]), 0.0f,
+                        -2.0f * (p.z - params[2]));
+
+                case TapeOp::Cylinder:
+                    return Normal(2.0f * (p.x - params[0]), 0.0f,
+                        2.0f * (p.z - params[1]));
+
+                default:
+                    return Normal(0.0f);
+                }
+            }
+
+            std::vector<TapeInstruction> mInstructions;
+            std::vector<ImplicitField const*> mSources;
+            std::vector<float> mParams;
+            std::vector<ImplicitField const*> mFields;
+            ImplicitField const* mSource;
+            std::size_t mDepth, mMaxDepth;
+            bool mFlat;
+        };
+    }
+}
+
+#endif
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "ImplicitField.hpp"
+#include "Tape.hpp"
 
 #include <atlas/core/Float.hpp>
 
@@ -75,6 +76,18 @@ namespace athena
                 return seeds;
             }
 
+            bool hasCompactSupport() const override
+            {
+                return true;
+            }
+
+            bool compile(Tape& tape) const override
+            {
+                tape.pushPrimitive(TapeOp::Torus,
+                    { mCentre.x, mCentre.y, mCentre.z, mC, mA });
+                return true;
+            }
+
         private:
             float sdf(atlas::math::Point const& p) const override
             {
@@ -99,13 +112,46 @@ namespace athena
                 return Normal(dx, dy, dz);
             }
 
+            void sdfBatch(PointBatch const& points,
+                std::vector<float>& values) const override
+            {
+                const float cx = mCentre.x, cy = mCentre.y, cz = mCentre.z;
+                const float a2 = mA * mA;
+                float const* x = points.x.data();
+                float const* y = points.y.data();
+                float const* z = points.z.data();
+                float* out = values.data();
+                for (std::size_t i = 0; i < points.size(); ++i)
+                {
+                    float dx = x[i] - cx;
+                    float dy = y[i] - cy;
+                    float dz = z[i] - cz;
+                    float root = std::sqrt(dx * dx + dy * dy);
+                    float left = (mC - root) * (mC - root);
+                    out[i] = left + dz * dz - a2;
+                }
+            }
+
+            void sdgBatch(PointBatch const& points,
+                NormalBatch& grads) const override
+            {
+                for (std::size_t i = 0; i < points.size(); ++i)
+                {
+                    float dx = points.x[i] - mCentre.x;
+                    float dy = points.y[i] - mCentre.y;
+                    float sqrt = std::sqrt(dx * dx + dy * dy);
+                    grads.x[i] = -2.0f * (mC - sqrt) * dx / sqrt;
+                    grads.y[i] = -2.0f * (mC - sqrt) * dy / sqrt;
+                    grads.z[i] = 2.0f * (points.z[i] - mCentre.z);
+                }
+            }
+
             atlas::utils::BBox box() const override
             {
                 using atlas::math::Point;
 
-                Point p = {  mC + mA,  mC + mA, -mA };
-                Point q = { -mC - mA, -mC - mA,  mA };
-                return atlas::utils::BBox(p, q);
+                Point extent = { mC + mA, mC + mA, mA };
+                return atlas::utils::BBox(mCentre - extent, mCentre + extent);
             }
 
             float mC, mA;
@@ -7,6 +7,8 @@
 #include "athena/polygonizer/MarchingCubes.hpp"
 
 #include <functional>
+#include <string>
+#include <vector>
 
 #define MAKE_SOID_FUNCTION(name) \
 athena::polygonizer::Bsoid make##name()
@@ -14,6 +16,9 @@ athena::polygonizer::Bsoid make##name()
 #define MAKE_MC_FUNCTION(name) \
 athena::polygonizer::MarchingCubes makeMC##name()
 
+#define MAKE_TREE_FUNCTION(name) \
+athena::tree::TreePointer make##name##Tree()
+
 
 namespace athena
 {
@@ -22,6 +27,29 @@ namespace athena
         using ModelFn = std::function<athena::polygonizer::Bsoid()>;
         using MCModelFn = std::function<athena::polygonizer::MarchingCubes()>;
 
+        enum class ModelResolution : int
+        {
+            Low = 0,
+            Mid,
+            High
+        };
+
+        // A model that can be polygonized by either method at any of the
+        // predefined resolutions.
+        struct ModelEntry
+        {
+            std::string name;
+            std::function<polygonizer::Bsoid(ModelResolution)> makeSoid;
+            std::function<polygonizer::MarchingCubes(ModelResolution)> makeMC;
+        };
+
+        MAKE_TREE_FUNCTION(Sphere);
+        MAKE_TREE_FUNCTION(Peanut);
+        MAKE_TREE_FUNCTION(Cylinder);
+        MAKE_TREE_FUNCTION(Cone);
+        MAKE_TREE_FUNCTION(Torus);
+        MAKE_TREE_FUNCTION(Chain);
+
         MAKE_SOID_FUNCTION(Sphere);
         MAKE_SOID_FUNCTION(Peanut);
         MAKE_SOID_FUNCTION(Cylinder);
@@ -35,6 +63,8 @@ namespace athena
         MAKE_MC_FUNCTION(Cone);
         MAKE_MC_FUNCTION(Torus);
         MAKE_MC_FUNCTION(Chain);
+
+        std::vector<ModelEntry> getModelCatalog();
     }
 }
 
@@ -5,7 +5,9 @@
 
 #include "Operators.hpp"
 #include "athena/fields/ImplicitField.hpp"
+#include "athena/fields/Tape.hpp"
 
+#include <algorithm>
 #include <vector>
 
 namespace athena
@@ -28,7 +30,7 @@ namespace athena
                 return box();
             }
 
-            void insertField(fields::ImplicitFieldPtr const& field)
+            virtual void insertField(fields::ImplicitFieldPtr const& field)
             {
                 mFields.push_back(field);
             }
@@ -52,9 +54,35 @@ namespace athena
                 return sdg(p);
             }
 
+            fields::FieldSample evalWithGradient(
+                atlas::math::Point const& p) const override
+            {
+                return sdfWithGradient(p);
+            }
+
+            void evalBatch(fields::PointBatch const& points,
+                std::vector<float>& values) const override
+            {
+                values.resize(points.size());
+                sdfBatch(points, values);
+            }
+
+            void gradBatch(fields::PointBatch const& points,
+                fields::NormalBatch& grads) const override
+            {
+                grads.resize(points.size());
+                sdgBatch(points, grads);
+            }
+
         protected:
             virtual ImplicitOperator* cloneEmpty() const = 0;
 
+            virtual fields::FieldSample sdfWithGradient(
+                atlas::math::Point const& p) const
+            {
+                return { sdf(p), sdg(p) };
+            }
+
             std::vector<fields::ImplicitFieldPtr> mFields;
         };
 
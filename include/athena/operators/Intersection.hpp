@@ -35,6 +35,12 @@ namespace athena
                 return result;
             }
 
+            bool compile(fields::Tape& tape) const override
+            {
+                tape.pushOperator(fields::TapeOp::Intersection, mFields);
+                return true;
+            }
+
         private:
             float sdf(atlas::math::Point const& p) const override
             {
@@ -58,6 +64,57 @@ namespace athena
                 return gradient;
             }
 
+            fields::FieldSample sdfWithGradient(
+                atlas::math::Point const& p) const override
+            {
+                fields::FieldSample sample = { atlas::core::infinity(),
+                    atlas::math::Normal(atlas::core::infinity()) };
+                for (auto& f : mFields)
+                {
+                    auto s = f->evalWithGradient(p);
+                    sample.value = glm::min(sample.value, s.value);
+                    sample.gradient = glm::min(sample.gradient, s.gradient);
+                }
+
+                return sample;
+            }
+
+            void sdfBatch(fields::PointBatch const& points,
+                std::vector<float>& values) const override
+            {
+                std::fill(values.begin(), values.end(), atlas::core::infinity());
+
+                std::vector<float> field;
+                for (auto& f : mFields)
+                {
+                    f->evalBatch(points, field);
+                    for (std::size_t i = 0; i < field.size(); ++i)
+                    {
+                        values[i] = glm::min(values[i], field[i]);
+                    }
+                }
+            }
+
+            void sdgBatch(fields::PointBatch const& points,
+                fields::NormalBatch& grads) const override
+            {
+                std::fill(grads.x.begin(), grads.x.end(), atlas::core::infinity());
+                std::fill(grads.y.begin(), grads.y.end(), atlas::core::infinity());
+                std::fill(grads.z.begin(), grads.z.end(), atlas::core::infinity());
+
+                fields::NormalBatch gradient;
+                for (auto& f : mFields)
+                {
+                    f->gradBatch(points, gradient);
+                    for (std::size_t i = 0; i < gradient.size(); ++i)
+                    {
+                        grads.x[i] = glm::min(grads.x[i], gradient.x[i]);
+                        grads.y[i] = glm::min(grads.y[i], gradient.y[i]);
+                        grads.z[i] = glm::min(grads.z[i], gradient.z[i]);
+                    }
+                }
+            }
+
             atlas::utils::BBox box() const override
             {
                 atlas::utils::BBox box;
@@ -0,0 +1,109 @@
+#ifndef ATHENA_INCLUDE_ATHENA_OPERATORS_PROFILED_OPERATOR_HPP
+#define ATHENA_INCLUDE_ATHENA_OPERATORS_PROFILED_OPERATOR_HPP
+
+#pragma once
+
+#include "Operators.hpp"
+#include "ImplicitOperator.hpp"
+#include "athena/fields/ProfiledField.hpp"
+
+namespace athena
+{
+    namespace operators
+    {
+        // The operator counterpart of ProfiledField. Children are inserted
+        // into the wrapped operator, and empty copies share the profile so
+        // pruned sub-trees still count towards the same node.
+        class ProfiledOperator : public ImplicitOperator
+        {
+        public:
+            ProfiledOperator(ImplicitOperatorPtr const& op,
+                fields::FieldProfilePtr const& profile) :
+                mOperator(op),
+                mProfile(profile)
+            { }
+
+            ~ProfiledOperator() = default;
+
+            void insertField(fields::ImplicitFieldPtr const& field) override
+            {
+                mOperator->insertField(field);
+            }
+
+            atlas::math::Normal naturalGradient(
+                atlas::math::Point const& p) const override
+            {
+                return mOperator->naturalGradient(p);
+            }
+
+            void naturalGradientBatch(fields::PointBatch const& points,
+                fields::NormalBatch& grads) const override
+            {
+                mOperator->naturalGradientBatch(points, grads);
+            }
+
+            std::vector<atlas::math::Point> getSeeds(
+                atlas::math::Normal const& u) const override
+            {
+                return mOperator->getSeeds(u);
+            }
+
+        private:
+            float sdf(atlas::math::Point const& p) const override
+            {
+                auto start = fields::ProfileClock::now();
+                float value = mOperator->eval(p);
+                mProfile->recordValue(value, start);
+                return value;
+            }
+
+            atlas::math::Normal sdg(atlas::math::Point const& p) const override
+            {
+                auto start = fields::ProfileClock::now();
+                auto gradient = mOperator->grad(p);
+                mProfile->recordCalls(1, start);
+                return gradient;
+            }
+
+            fields::FieldSample sdfWithGradient(
+                atlas::math::Point const& p) const override
+            {
+                auto start = fields::ProfileClock::now();
+                auto sample = mOperator->evalWithGradient(p);
+                mProfile->recordValue(sample.value, start);
+                return sample;
+            }
+
+            void sdfBatch(fields::PointBatch const& points,
+                std::vector<float>& values) const override
+            {
+                auto start = fields::ProfileClock::now();
+                mOperator->evalBatch(points, values);
+                mProfile->recordValues(values.data(), values.size(), start);
+            }
+
+            void sdgBatch(fields::PointBatch const& points,
+                fields::NormalBatch& grads) const override
+            {
+                auto start = fields::ProfileClock::now();
+                mOperator->gradBatch(points, grads);
+                mProfile->recordCalls(points.size(), start);
+            }
+
+            atlas::utils::BBox box() const override
+            {
+                return mOperator->getBBox();
+            }
+
+            ProfiledOperator* cloneEmpty() const override
+            {
+                return new ProfiledOperator(mOperator->makeEmpty(), mProfile);
+            }
+
+            ImplicitOperatorPtr mOperator;
+            fields::FieldProfilePtr mProfile;
+        };
+    }
+}
+
+#endif
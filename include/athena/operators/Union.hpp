@@ -32,6 +32,12 @@ namespace athena
                 return result;
             }
 
+            bool compile(fields::Tape& tape) const override
+            {
+                tape.pushOperator(fields::TapeOp::Union, mFields);
+                return true;
+            }
+
         private:
             float sdf(atlas::math::Point const& p) const override
             {
@@ -55,6 +61,56 @@ namespace athena
                 return gradient;
             }
 
+            fields::FieldSample sdfWithGradient(
+                atlas::math::Point const& p) const override
+            {
+                fields::FieldSample sample = { 0.0f, atlas::math::Normal(0.0f) };
+                for (auto& f : mFields)
+                {
+                    auto s = f->evalWithGradient(p);
+                    sample.value = glm::max(sample.value, s.value);
+                    sample.gradient = glm::max(sample.gradient, s.gradient);
+                }
+
+                return sample;
+            }
+
+            void sdfBatch(fields::PointBatch const& points,
+                std::vector<float>& values) const override
+            {
+                std::fill(values.begin(), values.end(), 0.0f);
+
+                std::vector<float> field;
+                for (auto& f : mFields)
+                {
+                    f->evalBatch(points, field);
+                    for (std::size_t i = 0; i < field.size(); ++i)
+                    {
+                        values[i] = glm::max(values[i], field[i]);
+                    }
+                }
+            }
+
+            void sdgBatch(fields::PointBatch const& points,
+                fields::NormalBatch& grads) const override
+            {
+                std::fill(grads.x.begin(), grads.x.end(), 0.0f);
+                std::fill(grads.y.begin(), grads.y.end(), 0.0f);
+                std::fill(grads.z.begin(), grads.z.end(), 0.0f);
+
+                fields::NormalBatch gradient;
+                for (auto& f : mFields)
+                {
+                    f->gradBatch(points, gradient);
+                    for (std::size_t i = 0; i < gradient.size(); ++i)
+                    {
+                        grads.x[i] = glm::max(grads.x[i], gradient.x[i]);
+                        grads.y[i] = glm::max(grads.y[i], gradient.y[i]);
+                        grads.z[i] = glm::max(grads.z[i], gradient.z[i]);
+                    }
+                }
+            }
+
             atlas::utils::BBox box() const override
             {
                 atlas::utils::BBox box;
@@ -46,6 +46,12 @@ namespace athena
             atlas::utils::Mesh linkContours();
             atlas::utils::Mesh connectContours();
 
+            // Connects a single pair of neighbouring slices. The result only
+            // holds the vertices of the two slices.
+            static atlas::utils::Mesh linkPair(
+                std::vector<std::vector<FieldPoint>> const& top,
+                std::vector<std::vector<FieldPoint>> const& bottom);
+
         private:
             using Slice = std::vector<std::vector<std::uint32_t>>;
 
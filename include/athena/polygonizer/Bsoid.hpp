@@ -7,7 +7,9 @@
 #include "CrossSection.hpp"
 #include "Lattice.hpp"
 #include "Contour.hpp"
+#include "Stats.hpp"
 #include "athena/tree/BlobTree.hpp"
+#include "athena/fields/ProfiledField.hpp"
 
 #include <atlas/utils/Mesh.hpp>
 
@@ -15,38 +17,66 @@
 #include <string>
 #include <cinttypes>
 #include <vector>
+#include <functional>
+#include <memory>
 
 namespace athena
 {
     namespace polygonizer
     {
+        // Receives the mesh strips produced by a streaming polygonization.
+        using MeshSink = std::function<void(atlas::utils::Mesh const&)>;
+
         class Bsoid
         {
         public:
             Bsoid();
+            Bsoid(tree::TreePointer const& model, std::string const& name,
+                float isoValue = 0.5f);
             Bsoid(tree::BlobTree const& model, std::string const& name,
                 float isoValue = 0.5f);
             Bsoid(Bsoid&& b);
 
             ~Bsoid() = default;
 
+            void setModel(tree::TreePointer const& tree);
             void setModel(tree::BlobTree const& tree);
             void setIsoValue(float isoValue);
+            float isoValue() const;
             void setSlicingAxis(SlicingAxes const& axis);
+            void setRootFinder(RootFinder method, float tolerance = 1.0e-4f,
+                std::size_t maxIterations = 8);
+
+            // Polygonizes a copy of the model that records every node it
+            // evaluates, and appends a per-node report to the log. The copy
+            // can't use the compiled tape, so this is much slower.
+            void setProfiling(bool enabled);
+
+            // Schedules polygonize as a graph instead of stage by stage, so a
+            // pair of slices is linked as soon as both have their contours.
+            // Each pair is resampled to its own size, so the strips don't
+            // share vertices.
+            void setPipelined(bool enabled);
 
             void setCrossSectionDelta(float delta);
             void setNumCrossSections(std::size_t num);
             std::size_t numCrossSections() const;
             float crossSectionDelta() const;
             SlicingAxes axis() const;
-            tree::BlobTree* tree() const;
+            tree::TreePointer const& tree() const;
 
             void makeCrossSections(std::uint32_t gridSize, std::uint32_t svSize);
 
             void constructLattices();
             void constructContours();
             void constructMesh();
-            void polygonize();
+            PolygonizerStats polygonize();
+
+            // Builds the slices in order and links each one to the previous
+            // as soon as its contours are done. Each strip is handed to the
+            // sink instead of being kept, and only two slices hold their
+            // samples at any time. Strips don't share vertices.
+            PolygonizerStats polygonizeStreaming(MeshSink const& sink);
 
             std::size_t getNumSlices() const;
             Lattice const& getLattice() const;
@@ -63,6 +93,11 @@ namespace athena
 
         private:
             void connectContours();
+            void removeBranchSections();
+            void forEachSection(std::function<void(CrossSection&)> const& fn);
+            PolygonizerStats polygonizePipelined();
+            void logSummary(PolygonizerStats const& stats,
+                std::size_t evaluations, std::string const& mode);
 
             Lattice mLattice;
             Contour mContour;
@@ -71,9 +106,18 @@ namespace athena
             SlicingAxes mAxis;
 
             std::vector<CrossSectionPointer> mCrossSections;
+            std::vector<CrossSection const*> mBranchSections;
             atlas::utils::Mesh mMesh;
             float mMagic;
 
+            RootFinder mRootFinder;
+            float mRootTolerance;
+            std::size_t mMaxRootIterations;
+
+            tree::TreePointer mUnprofiledTree;
+            std::shared_ptr<fields::FieldProfiler> mProfiler;
+            bool mPipelined;
+
             std::stringstream mLog;
             std::string mName;
         };
@@ -7,16 +7,20 @@
 #include "Voxel.hpp"
 #include "SuperVoxel.hpp"
 #include "LineSegment.hpp"
+#include "GridCache.hpp"
+#include "Stats.hpp"
 #include "athena/fields/ImplicitField.hpp"
 #include "athena/tree/BlobTree.hpp"
 
 #include <atlas/math/Math.hpp>
 #include <atlas/core/Macros.hpp>
 
+#include <atomic>
 #include <cstdint>
-#include <unordered_map>
+#include <vector>
 #include <map>
 #include <memory>
+#include <mutex>
 
 namespace athena
 {
@@ -27,16 +31,39 @@ namespace athena
         public:
             CrossSection(SlicingAxes const& axis, atlas::math::Point const& min,
                 atlas::math::Point const& max, std::uint32_t gridSize,
-                std::uint32_t svSize, float isoValue, tree::BlobTree* tree);
+                std::uint32_t svSize, float isoValue, tree::BlobTree const* tree);
             ~CrossSection() = default;
 
             void constructLattice();
             void constructContour();
             void resizeContours(std::size_t size);
 
+            // Same as resizeContours, but leaves the section's own contours
+            // as they are so they can be resampled again to another size.
+            // Neighbouring pairs may call this on the same section at once.
+            std::vector<std::vector<FieldPoint>> resampleContours(
+                std::size_t size);
+
+            // Frees everything built from the field. The section can still
+            // be used, the next constructLattice samples it again.
+            void release();
+
+            // Field samples don't depend on the iso-value, so they are kept
+            // and the next constructLattice only re-marches them.
+            void setIsoValue(float isoValue);
+
+            void setRootFinder(RootFinder method, float tolerance = 1.0e-4f,
+                std::size_t maxIterations = 8);
+            // Both only cover the last constructLattice and what followed
+            // it, so a section that is polygonized again counts from zero.
+            std::size_t getNumRootEvaluations() const;
+            std::size_t getNumFieldSamples() const;
+            SectionStats const& getStats() const;
+
             std::vector<FieldPoint> findShadowPoints();
 
             std::vector<Voxel> const& getVoxels() const;
+            PointPool const& getPoints() const;
             std::vector<std::vector<FieldPoint>> const& getContour() const;
             std::size_t getLargestContourSize() const;
             atlas::math::Normal getNormal() const;
@@ -47,8 +74,12 @@ namespace athena
                 atlas::math::Point const& delta);
             atlas::math::Point createCellPoint(glm::u32vec2 const& p,
                 atlas::math::Point const& delta);
+            std::uint32_t superVoxelIndex(std::uint32_t x,
+                std::uint32_t y) const;
+
+            void sampleField();
 
-            FieldPoint findVoxelPoint(PointId const& id);
+            std::uint32_t findVoxelPoint(PointId const& id);
             void fillVoxel(Voxel& v);
             bool seenVoxel(VoxelId const& id);
             void marchVoxelOnSurface(std::vector<Voxel> const& seeds);
@@ -58,7 +89,14 @@ namespace athena
                 std::vector<Voxel> const& voxels);
             std::vector<std::vector<FieldPoint>> 
                 convertToContour(std::vector<LineSegment> const& segments);
-            void subdivideContour(int idx, std::size_t size);
+            std::vector<FieldPoint> subdivideContour(
+                std::vector<FieldPoint> const& contour, std::size_t size,
+                std::size_t& evaluations) const;
+            FieldPoint findRoot(FieldPoint const& p1, FieldPoint const& p2,
+                std::size_t& evaluations) const;
+            FieldPoint pushToSurface(atlas::math::Point const& p,
+                FieldPoint const& origin, float delta,
+                std::size_t& evaluations) const;
 
             float shadowField(FieldPoint const& p);
             std::vector<Voxel> findShadowVoxels();
@@ -70,6 +108,7 @@ namespace athena
             void validateVoxels() const;
             void validateContour() const;
 
+
             atlas::math::Point mGridDelta, mSvDelta, mMin, mMax;
             atlas::math::Normal mNormal;
             atlas::math::Normal mUnitNormal;
@@ -78,18 +117,34 @@ namespace athena
             float mMagic;
             float mShadowMagic;
 
-            tree::BlobTree* mTree;
+            RootFinder mRootFinder;
+            float mRootTolerance;
+            std::size_t mMaxRootIterations;
+            std::atomic<std::size_t> mRootEvaluations;
+            std::size_t mPointsBeforeLattice;
+
+            tree::BlobTree const* mTree;
             SlicingAxes mAxis;
 
             std::vector<Voxel> mVoxels;
+            PointPool mPoints;
             std::vector<std::vector<FieldPoint>> mContours;
 
-            std::unordered_map<std::uint32_t, SuperVoxel> mSuperVoxels;
+            // Indexed by superVoxelIndex(x, y). Cells that don't overlap
+            // the model have a null field.
+            std::vector<SuperVoxel> mSuperVoxels;
 
-            std::map<std::uint32_t, FieldPoint> mSeenVoxelPoints;
-            std::map<std::uint32_t, VoxelId> mSeenVoxels;
+            PointCache mSeenVoxelPoints;
+            VoxelSet mSeenVoxels;
+            EdgeCache mEdgeCache;
 
             std::size_t mLargestContourSize;
+
+            std::vector<Voxel> mSeedVoxels;
+            bool mHasSamples;
+
+            SectionStats mStats;
+            std::mutex mStatsMutex;
         };
     }
 }
@@ -0,0 +1,253 @@
+#ifndef ATHENA_INCLUDE_ATHENA_POLYGONIZER_GRID_CACHE_HPP
+#define ATHENA_INCLUDE_ATHENA_POLYGONIZER_GRID_CACHE_HPP
+
+#pragma once
+
+#include "Voxel.hpp"
+#include "LineSegment.hpp"
+#include "Hash.hpp"
+
+#include <cinttypes>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace athena
+{
+    namespace polygonizer
+    {
+        // Grids with more points than this use the sparse storage instead of
+        // allocating the full (gridSize + 1)^2 arrays. Going by the grid
+        // cache sweep in athena_bench, dense lookups are about 5x cheaper
+        // than hashed ones. Clearing the arrays is what costs, and at 1024
+        // that makes up for the faster lookups while taking 14x the memory.
+        // So grids up to 512 are dense. Both caches go by the number of
+        // points, so at 1024 both of them are hashed.
+        constexpr std::size_t maxDenseCachePoints = 1u << 20;
+
+        // Open-addressing hash map with linear probing. The keys are grid
+        // hashes, so the all-ones key is reserved to mark empty slots.
+        template <typename Key, typename Value>
+        class FlatHashMap
+        {
+        public:
+            FlatHashMap() :
+                mSize(0)
+            { }
+
+            Value const* find(Key key) const
+            {
+                if (mKeys.empty())
+                {
+                    return nullptr;
+                }
+
+                std::size_t mask = mKeys.size() - 1;
+                for (std::size_t i = slot(key); ; i = (i + 1) & mask)
+                {
+                    if (mKeys[i] == key)
+                    {
+                        return &mValues[i];
+                    }
+
+                    if (mKeys[i] == emptyKey())
+                    {
+                        return nullptr;
+                    }
+                }
+            }
+
+            Value* find(Key key)
+            {
+                return const_cast<Value*>(
+                    static_cast<FlatHashMap const&>(*this).find(key));
+            }
+
+            // Returns false (and leaves the stored value alone) if the key
+            // was already in the map.
+            bool insert(Key key, Value const& value)
+            {
+                if ((mSize + 1) * 2 > mKeys.size())
+                {
+                    rehash(mKeys.empty() ? 16 : mKeys.size() * 2);
+                }
+
+                std::size_t mask = mKeys.size() - 1;
+                for (std::size_t i = slot(key); ; i = (i + 1) & mask)
+                {
+                    if (mKeys[i] == key)
+                    {
+                        return false;
+                    }
+
+                    if (mKeys[i] == emptyKey())
+                    {
+                        mKeys[i] = key;
+                        mValues[i] = value;
+                        ++mSize;
+                        return true;
+                    }
+                }
+            }
+
+            void reserve(std::size_t size)
+            {
+                std::size_t capacity = 16;
+                while (capacity < size * 2)
+                {
+                    capacity *= 2;
+                }
+
+                if (capacity > mKeys.size())
+                {
+                    rehash(capacity);
+                }
+            }
+
+            std::size_t size() const
+            {
+                return mSize;
+            }
+
+            void clear()
+            {
+                mKeys.clear();
+                mValues.clear();
+                mSize = 0;
+            }
+
+        private:
+            static constexpr Key emptyKey()
+            {
+                return std::numeric_limits<Key>::max();
+            }
+
+            std::size_t slot(Key key) const
+            {
+                // Fibonacci hashing, since the grid hashes are far from
+                // uniformly distributed in the low bits.
+                std::uint64_t h = static_cast<std::uint64_t>(key) *
+                    0x9E3779B97F4A7C15ull;
+                return static_cast<std::size_t>(h ^ (h >> 32)) &
+                    (mKeys.size() - 1);
+            }
+
+            void rehash(std::size_t capacity)
+            {
+                std::vector<Key> keys(capacity, emptyKey());
+                std::vector<Value> values(capacity);
+                keys.swap(mKeys);
+                values.swap(mValues);
+                mSize = 0;
+
+                for (std::size_t i = 0; i < keys.size(); ++i)
+                {
+                    if (keys[i] != emptyKey())
+                    {
+                        insert(keys[i], values[i]);
+                    }
+                }
+            }
+
+            std::vector<Key> mKeys;
+            std::vector<Value> mValues;
+            std::size_t mSize;
+        };
+
+        // Maps each sampled grid point of a cross-section to its index in
+        // the point pool.
+        class PointCache
+        {
+        public:
+            PointCache();
+
+            // Grids with more than maxDensePoints points use the hash map.
+            void reset(std::uint32_t gridSize,
+                std::size_t maxDensePoints = maxDenseCachePoints);
+            void clear();
+
+            // Returns invalidUint() if the point hasn't been sampled.
+            std::uint32_t find(PointId const& id) const;
+            void insert(PointId const& id, std::uint32_t index);
+
+            std::size_t size() const;
+            bool isDense() const;
+
+        private:
+            std::uint32_t mStride;
+            bool mDense;
+            std::size_t mSize;
+            std::vector<std::uint32_t> mEntries;
+            FlatHashMap<std::uint32_t, std::uint32_t> mSparseEntries;
+        };
+
+        // Keeps track of the voxels that have been visited while marching
+        // a cross-section.
+        class VoxelSet
+        {
+        public:
+            VoxelSet();
+
+            void reset(std::uint32_t gridSize,
+                std::size_t maxDensePoints = maxDenseCachePoints);
+            void clear();
+
+            // Returns true if the voxel had not been seen before.
+            bool insert(VoxelId const& id);
+            bool contains(VoxelId const& id) const;
+
+            std::size_t size() const;
+
+        private:
+            std::uint32_t mStride;
+            bool mDense;
+            std::size_t mSize;
+            std::vector<bool> mBits;
+            FlatHashMap<std::uint32_t, std::uint8_t> mSparseVoxels;
+        };
+
+        // The contouring passes of a cross-section. They cross the same
+        // lattice edges but at different iso-values.
+        enum class EdgePass : std::uint32_t
+        {
+            Surface = 0,
+            Shadow
+        };
+
+        // Lattice edges are identified by their lower end point and their
+        // axis, so both directions of an edge give the same id.
+        inline std::uint64_t edgeId(PointId const& a, PointId const& b)
+        {
+            auto const& origin = (a.x < b.x || a.y < b.y) ? a : b;
+            std::uint64_t axis = (a.x != b.x) ? 0 : 1;
+            return (static_cast<std::uint64_t>(
+                BsoidHash32::hash(origin.x, origin.y)) << 1) | axis;
+        }
+
+        // Iso-points computed on the lattice edges of a cross-section,
+        // shared by all of its contouring passes. Each pass numbers its
+        // points from zero.
+        class EdgeCache
+        {
+        public:
+            EdgeCache();
+
+            void clear();
+
+            LinePoint const* find(std::uint64_t edge, EdgePass pass) const;
+            LinePoint insert(std::uint64_t edge, EdgePass pass,
+                FieldPoint const& point);
+
+            std::size_t size() const;
+            std::uint32_t numPoints(EdgePass pass) const;
+
+        private:
+            static std::uint64_t key(std::uint64_t edge, EdgePass pass);
+
+            FlatHashMap<std::uint64_t, LinePoint> mPoints;
+            std::uint32_t mNumPoints[2];
+        };
+    }
+}
+
+#endif
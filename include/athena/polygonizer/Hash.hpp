@@ -30,7 +30,7 @@ namespace athena
 #include <atlas/math/Math.hpp>
 #include <tuple>
 
-        glm::u32vec2 reverseHash32(std::uint32_t hash)
+        inline glm::u32vec2 reverseHash32(std::uint32_t hash)
         {
             std::uint32_t mask = 0xFFFF;
             std::uint32_t y = hash & mask;
@@ -38,7 +38,7 @@ namespace athena
             return { x, y };
         }
 
-        std::tuple<glm::u32vec2, glm::u32vec2> reverseHash64(std::uint64_t hash)
+        inline std::tuple<glm::u32vec2, glm::u32vec2> reverseHash64(std::uint64_t hash)
         {
             std::uint64_t mask = 0xFFFFFFFF;
             std::uint32_t u = hash & mask;
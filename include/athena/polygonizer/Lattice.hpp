@@ -16,7 +16,9 @@ namespace athena
         {
             Lattice() = default;
 
-            void makeLattice(std::vector<std::vector<Voxel>> const& voxels);
+            void makeLattice(
+                std::vector<std::vector<Voxel> const*> const& voxels,
+                std::vector<PointPool const*> const& points);
             void clearBuffers();
 
             std::vector<atlas::math::Point> vertices;
@@ -20,11 +20,23 @@ namespace athena
 
             LinePoint(FieldPoint const& p, std::uint64_t const& e) :
                 point(p),
-                edge(e)
+                edge(e),
+                id(invalidUint())
+            { }
+
+            LinePoint(FieldPoint const& p, std::uint64_t const& e,
+                std::uint32_t i) :
+                point(p),
+                edge(e),
+                id(i)
             { }
 
             FieldPoint point;
             std::uint64_t edge;
+
+            // Compact index of the point within its cross-section, so
+            // segments can be chained without hashing.
+            std::uint32_t id;
         };
 
         struct LineSegment
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "Polygonizer.hpp"
+#include "Stats.hpp"
 #include "athena/tree/BlobTree.hpp"
 
 #include <atlas/utils/Mesh.hpp>
@@ -21,17 +22,24 @@ namespace athena
         {
         public:
             MarchingCubes();
+            MarchingCubes(tree::TreePointer const& model, std::string const& name,
+                float isoValue = 0.5f);
             MarchingCubes(tree::BlobTree const& model, std::string const& name,
                 float isoValue = 0.5f);
             MarchingCubes(MarchingCubes&& mc);
 
             ~MarchingCubes() = default;
 
+            void setModel(tree::TreePointer const& tree);
             void setModel(tree::BlobTree const& tree);
             void setIsoValue(float isoValue);
             void setResolution(glm::u32vec3 const& res);
 
-            void polygonize();
+            // When enabled, only the cells that the surface passes through
+            // are visited, starting from the seeds of the model.
+            void setSparse(bool sparse);
+
+            PolygonizerStats polygonize();
 
             atlas::utils::Mesh& getMesh();
 
@@ -51,17 +59,50 @@ namespace athena
                 atlas::math::Vector4 data;
             };
 
+            void setUpGrid();
             void constructGrid();
-            void createTriangles();
+            void polygonizeSparse();
+
+            // The edge to vertex table holds three entries per grid point,
+            // so it only lives until the triangles have been made.
+            std::vector<std::uint32_t> createVertices();
+            void createTriangles(
+                std::vector<std::uint32_t> const& edgeVertices);
+
+            // The grid is stored with z varying fastest.
+            std::size_t gridIndex(std::size_t x, std::size_t y,
+                std::size_t z) const
+            {
+                return (x * mResolution.y + y) * mResolution.z + z;
+            }
+
+            // Each grid point owns the three edges that leave it along the
+            // positive x, y, and z axes.
+            std::size_t edgeIndex(std::size_t point, std::size_t axis) const
+            {
+                return point * 3 + axis;
+            }
+
+            atlas::math::Point gridPoint(std::size_t x, std::size_t y,
+                std::size_t z) const
+            {
+                return
+                {
+                    mStart.x + x * mDelta.x,
+                    mStart.y + y * mDelta.y,
+                    mStart.z + z * mDelta.z
+                };
+            }
 
             glm::u32vec3 mResolution;
+            atlas::math::Point mStart;
+            glm::vec3 mDelta;
+            bool mSparse;
             atlas::utils::Mesh mMesh;
-            std::vector<std::vector<std::vector<VoxelPoint>>> mGrid;
-            std::vector<atlas::math::Point> mVertices;
-            std::vector<atlas::math::Normal> mNormals;
-            std::vector<std::uint32_t> mIndices;
+            std::vector<VoxelPoint> mGrid;
             tree::TreePointer mTree;
             float mMagic;
+            std::size_t mFieldEvaluations;
 
             std::stringstream mLog;
             std::string mName;
@@ -16,6 +16,19 @@ namespace athena
             ZAxis
         };
 
+        // How iso-crossings are refined once they have been bracketed.
+        // Linear does a single interpolation, the rest iterate until the
+        // field is within the tolerance of the iso-value. Resampled contour
+        // points are always projected with Newton steps, the policy only
+        // changes how lattice edges are refined.
+        enum class RootFinder : int
+        {
+            Linear = 0,
+            Secant,
+            Newton,
+            Bisection
+        };
+
         class Bsoid;
         class CrossSection;
         struct Lattice;
@@ -0,0 +1,83 @@
+#ifndef ATHENA_INCLUDE_ATHENA_POLYGONIZER_STATS_HPP
+#define ATHENA_INCLUDE_ATHENA_POLYGONIZER_STATS_HPP
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Hot-path counters and per-slice timers only exist when the build enables
+// them, otherwise ATHENA_STATS(...) expands to nothing.
+#if defined(ATHENA_STATS_ENABLED)
+#define ATHENA_STATS(expr) expr
+#else
+#define ATHENA_STATS(expr)
+#endif
+
+namespace athena
+{
+    namespace polygonizer
+    {
+        // Everything here is only filled in when stats are enabled.
+        struct SectionStats
+        {
+            // Wall time in seconds.
+            float lattice = 0.0f;
+            float contour = 0.0f;
+            float resize = 0.0f;
+
+            std::size_t fieldSamples = 0;
+            std::size_t pointCacheHits = 0;
+            std::size_t voxelsMarched = 0;
+
+            // Evaluations spent on the iso-crossings of the lattice edges
+            // and on pushing the resampled contours back to the surface.
+            std::size_t rootEvaluations = 0;
+            std::size_t surfaceEvaluations = 0;
+
+            std::size_t contours = 0;
+        };
+
+        struct StageStats
+        {
+            std::string name;
+            float time;
+        };
+
+        struct PolygonizerStats
+        {
+            float stage(std::string const& name) const
+            {
+                for (auto& s : stages)
+                {
+                    if (s.name == name)
+                    {
+                        return s.time;
+                    }
+                }
+
+                return 0.0f;
+            }
+
+            // Stage times are always recorded, in the order they ran.
+            std::vector<StageStats> stages;
+            float total = 0.0f;
+
+            std::size_t vertices = 0;
+
+            // Every value or gradient the polygonizer asked the field for,
+            // so the rates of different polygonizers can be compared.
+            std::size_t fieldEvaluations = 0;
+
+            // Cells run through the marching cubes kernel, timed by the
+            // "cells" stage. Zero for the other polygonizers.
+            std::size_t cells = 0;
+
+            // One entry per cross-section, empty when stats are disabled.
+            std::vector<SectionStats> sections;
+        };
+    }
+}
+
+#endif
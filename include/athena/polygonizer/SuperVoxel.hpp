@@ -28,6 +28,12 @@ namespace athena
                 return field->grad(p);
             }
 
+            fields::FieldSample evalWithGradient(
+                atlas::math::Point const& p) const
+            {
+                return field->evalWithGradient(p);
+            }
+
             glm::u32vec2 id;
             fields::ImplicitFieldPtr field;
             atlas::utils::BBox cell;
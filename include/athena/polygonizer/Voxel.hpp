@@ -7,6 +7,8 @@
 
 #include <cinttypes>
 #include <array>
+#include <limits>
+#include <vector>
 
 #if defined(max)
 #undef max
@@ -66,6 +68,64 @@ namespace athena
             return std::numeric_limits<std::uint32_t>::max();
         }
 
+        // Structure-of-arrays storage for the lattice points of a
+        // cross-section. Voxels refer to their corners by index, so points
+        // shared between neighbouring voxels are only stored once.
+        struct PointPool
+        {
+            PointPool() = default;
+
+            std::uint32_t push_back(FieldPoint const& p)
+            {
+                x.push_back(p.value.x);
+                y.push_back(p.value.y);
+                z.push_back(p.value.z);
+                values.push_back(p.value.w);
+                gx.push_back(p.g.x);
+                gy.push_back(p.g.y);
+                gz.push_back(p.g.z);
+                svHashes.push_back(p.svHash);
+                return static_cast<std::uint32_t>(x.size() - 1);
+            }
+
+            FieldPoint operator[](std::uint32_t i) const
+            {
+                return FieldPoint({ x[i], y[i], z[i] }, values[i],
+                    { gx[i], gy[i], gz[i] }, svHashes[i]);
+            }
+
+            atlas::math::Point position(std::uint32_t i) const
+            {
+                return { x[i], y[i], z[i] };
+            }
+
+            float value(std::uint32_t i) const
+            {
+                return values[i];
+            }
+
+            std::size_t size() const
+            {
+                return x.size();
+            }
+
+            void clear()
+            {
+                x.clear();
+                y.clear();
+                z.clear();
+                values.clear();
+                gx.clear();
+                gy.clear();
+                gz.clear();
+                svHashes.clear();
+            }
+
+            std::vector<float> x, y, z, values;
+            std::vector<float> gx, gy, gz;
+            std::vector<std::uint32_t> svHashes;
+        };
+
 
         using PointId = glm::u32vec2;
         using VoxelId = PointId;
@@ -74,11 +134,15 @@ namespace athena
         {
             Voxel() :
                 id(invalidUint())
-            { }
+            {
+                points.fill(invalidUint());
+            }
 
             Voxel(glm::u64vec2 const& p) :
                 id(p)
-            { }
+            {
+                points.fill(invalidUint());
+            }
 
             bool isValid() const
             {
@@ -88,7 +152,8 @@ namespace athena
                     id.y != invalid.y);
             }
 
-            std::array<FieldPoint, 4> points;
+            // Indices into the point pool of the cross-section.
+            std::array<std::uint32_t, 4> points;
             VoxelId id;
         };
     }
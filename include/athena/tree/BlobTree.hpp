@@ -5,8 +5,14 @@
 
 #include "Tree.hpp"
 #include "Node.hpp"
+#include "Bvh.hpp"
 #include "athena/fields/ImplicitField.hpp"
+#include "athena/fields/Tape.hpp"
 
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace athena
@@ -28,19 +34,71 @@ namespace athena
 
             float eval(atlas::math::Point const& p) const;
             atlas::math::Normal grad(atlas::math::Point const& p) const;
+            fields::FieldSample evalWithGradient(
+                atlas::math::Point const& p) const;
             atlas::math::Normal naturalGradient(atlas::math::Point const& p) const;
 
+            void evalBatch(fields::PointBatch const& points,
+                std::vector<float>& values) const;
+            void gradBatch(fields::PointBatch const& points,
+                fields::NormalBatch& grads) const;
+            void naturalGradientBatch(fields::PointBatch const& points,
+                fields::NormalBatch& grads) const;
+
             fields::ImplicitFieldPtr getSubTree(
                 atlas::utils::BBox const& box) const;
 
+            // Drops every pruned tree built so far, for this tree and all of
+            // its copies. Fields already handed out stay valid.
+            void clearSubTreeCache() const;
+
             atlas::utils::BBox getTreeBox() const;
             std::vector<atlas::math::Point> getSeeds(
                 atlas::math::Normal const& u) const;
 
+            // Largest difference, in value or in any gradient component,
+            // between the culled evaluation and the full tape over the given
+            // points.
+            float maxCullingError(
+                std::vector<atlas::math::Point> const& points) const;
+
+            // Builds a copy of the tree with every node wrapped so that its
+            // evaluations are recorded in the profiler.
+            TreePointer makeProfiled(fields::FieldProfiler& profiler) const;
+
         private:
+            // Pruned trees are shared between all cells that overlap the
+            // same set of leaves. Copies of the tree share the node graph,
+            // so they share this as well.
+            struct SubTreeCache
+            {
+                std::mutex mutex;
+                std::map<std::vector<std::uint32_t>, fields::ImplicitFieldPtr>
+                    subTrees;
+            };
+
+            void buildLeafBvh();
+            void linkLeavesToTape();
+            bool findActiveLeaves(atlas::math::Point const& p,
+                std::uint32_t* active, std::size_t& numActive) const;
+
+            // Points that fall in more leaves than this are evaluated
+            // without culling.
+            static constexpr std::size_t maxActiveLeaves = 32;
+
+            // Marks the leaves in mLeafInstructions that are never culled.
+            static constexpr std::uint32_t unboundedLeaf =
+                std::numeric_limits<std::uint32_t>::max();
+
             std::vector<NodePtr> mNodes;
             NodePtr mVolumeTree;
+            std::vector<Node const*> mLeaves;
+            Bvh mLeafBvh;
+            std::shared_ptr<SubTreeCache> mSubTreeCache;
             fields::ImplicitFieldPtr mFieldTree;
+            fields::Tape mTape;
+            std::vector<std::uint32_t> mLeafInstructions;
+            std::vector<std::uint32_t> mUnboundedInstructions;
         };
     }
 }
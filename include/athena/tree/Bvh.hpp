@@ -0,0 +1,66 @@
+#ifndef ATHENA_INCLUDE_ATHENA_TREE_BVH_HPP
+#define ATHENA_INCLUDE_ATHENA_TREE_BVH_HPP
+
+#pragma once
+
+#include "Tree.hpp"
+
+#include <atlas/math/Math.hpp>
+#include <atlas/utils/BBox.hpp>
+
+#include <cinttypes>
+#include <vector>
+
+namespace athena
+{
+    namespace tree
+    {
+        // Bounding volume hierarchy over a fixed set of boxes. The boxes are
+        // referred to by their index in the list given to build.
+        class Bvh
+        {
+        public:
+            Bvh() = default;
+
+            void build(std::vector<atlas::utils::BBox> const& boxes);
+            void clear();
+            bool empty() const;
+
+            // Returns the sorted indices of all boxes that overlap the
+            // given box.
+            void query(atlas::utils::BBox const& box,
+                std::vector<std::uint32_t>& result) const;
+
+            // Writes the indices of the boxes that contain the point into
+            // result without allocating. Returns false if there are more
+            // than maxResults of them.
+            bool query(atlas::math::Point const& p, std::uint32_t* result,
+                std::size_t maxResults, std::size_t& numResults) const;
+
+        private:
+            static constexpr std::size_t maxLeafSize = 4;
+            static constexpr std::size_t maxDepth = 64;
+
+            // The nodes are stored depth-first, so the left child of a node
+            // always comes right after it.
+            struct BvhNode
+            {
+                atlas::utils::BBox box;
+                std::uint32_t first;
+                std::uint32_t count;
+                std::uint32_t right;
+            };
+
+            std::uint32_t buildNode(
+                std::vector<atlas::utils::BBox> const& boxes,
+                std::vector<atlas::math::Point> const& centres,
+                std::uint32_t first, std::uint32_t count, std::size_t depth);
+
+            std::vector<BvhNode> mNodes;
+            std::vector<std::uint32_t> mIndices;
+            std::vector<atlas::utils::BBox> mBoxes;
+        };
+    }
+}
+
+#endif
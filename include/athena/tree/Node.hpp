@@ -32,6 +32,14 @@ namespace athena
             fields::ImplicitFieldPtr subTree(
                 atlas::utils::BBox const& cell) const;
 
+            // Prunes the tree down to the given leaves, which must be sorted.
+            // Returns null if none of the leaves are under this node.
+            fields::ImplicitFieldPtr subTree(
+                std::vector<Node const*> const& leaves) const;
+
+            bool isLeaf() const;
+            fields::ImplicitFieldPtr getField() const;
+
         private:
             fields::ImplicitFieldPtr mField;
             NodePtr mParent;
@@ -13,7 +13,9 @@ namespace athena
         class BlobTree;
 
         using NodePtr = std::shared_ptr<Node>;
-        using TreePointer = std::unique_ptr<BlobTree>;
+        // Trees are immutable once built, so polygonizers and views share
+        // them instead of copying.
+        using TreePointer = std::shared_ptr<BlobTree const>;
     }
 }
 
@@ -18,7 +18,7 @@ namespace athena
         class FieldView : public atlas::utils::Geometry
         {
         public:
-            FieldView(tree::BlobTree* tree);
+            FieldView(tree::TreePointer const& tree);
             FieldView(FieldView&& view) = default;
             ~FieldView() = default;
 
@@ -38,7 +38,7 @@ namespace athena
             std::size_t mNumVertices;
 
             using IndexOffset = std::pair<std::size_t, std::size_t>;
-            tree::BlobTree* mTree;
+            tree::TreePointer mTree;
             std::size_t mNumSlices;
             std::vector<IndexOffset> mOffsets;
             int mSelectedSlice;
@@ -34,6 +34,9 @@ namespace athena
             void constructContours();
             void constructMesh();
             void constructMCMesh();
+            void uploadLattices();
+            void uploadContours();
+            void updateIsoValue();
 
             polygonizer::Bsoid mSoid;
             polygonizer::MarchingCubes mMC;
@@ -66,8 +69,17 @@ namespace athena
             bool mShowMesh;
             bool mShowMCMesh;
             bool mHasMC;
+
+            // What has been built so far, so an iso-value change only
+            // rebuilds those. Empty buffers can't tell us this, since an
+            // iso-value can give no surface at all.
+            bool mHasLattices;
+            bool mHasContours;
+            bool mHasMesh;
+
             int mRenderMode;
             int mSelectedSlice;
+            float mIsoValue;
         };
     }
 }
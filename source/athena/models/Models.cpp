@@ -38,270 +38,319 @@ namespace athena
         static const MCResolution midResolutionMC = { 32, 16, 16 };
         static const MCResolution highResolutionMC = { 64, 32, 32 };
 
-        constexpr Resolution currentResolution = highResolution;
-        static const MCResolution currentResolutionMC = highResolutionMC;
+        constexpr ModelResolution currentResolution = ModelResolution::High;
 
-        polygonizer::Bsoid makeSphere()
+        tree::TreePointer makeSphereTree()
         {
             using fields::Sphere;
 
-            ImplicitFieldPtr sphere = std::make_shared<Sphere>();
-            BlobTree tree;
-            tree.insertField(sphere);
-            tree.insertNodeTree({ { -1 } });
-            tree.insertFieldTree(sphere);
-
-            Bsoid soid(tree, "sphere");
-            soid.setSlicingAxis(SlicingAxes::YAxis);
-            soid.setNumCrossSections(std::get<0>(currentResolution));
-            soid.makeCrossSections(std::get<1>(currentResolution),
-                std::get<2>(currentResolution));
-            return soid;
+            // The tree is built once and shared by every polygonizer that
+            // asks for it.
+            static const tree::TreePointer sphereTree = []()
+            {
+                ImplicitFieldPtr sphere = std::make_shared<Sphere>();
+                auto tree = std::make_shared<BlobTree>();
+                tree->insertField(sphere);
+                tree->insertNodeTree({ { -1 } });
+                tree->insertFieldTree(sphere);
+                return tree;
+            }();
+
+            return sphereTree;
         }
 
-        polygonizer::MarchingCubes makeMCSphere()
+        tree::TreePointer makePeanutTree()
         {
+            using atlas::math::Point;
             using fields::Sphere;
+            using operators::Blend;
+
+            static const tree::TreePointer peanutTree = []()
+            {
+                ImplicitFieldPtr sphere1 =
+                    std::make_shared<Sphere>(1.0f, Point(1.0f, 0, 0));
+                ImplicitFieldPtr sphere2 =
+                    std::make_shared<Sphere>(1.0f, Point(-1.0f, 0, 0));
+                ImplicitOperatorPtr blend = std::make_shared<Blend>();
+                blend->insertFields({ sphere1, sphere2 });
+
+                auto tree = std::make_shared<BlobTree>();
+                tree->insertFields({ sphere1, sphere2, blend });
+                tree->insertNodeTree({ { -1 }, { -1 }, { 0, 1 } });
+                tree->insertFieldTree(blend);
+                return tree;
+            }();
+
+            return peanutTree;
+        }
 
-            ImplicitFieldPtr sphere = std::make_shared<Sphere>();
-            BlobTree tree;
-            tree.insertField(sphere);
-            tree.insertNodeTree({ { -1 } });
-            tree.insertFieldTree(sphere);
+        tree::TreePointer makeCylinderTree()
+        {
+            using fields::Cylinder;
 
-            MarchingCubes mc(tree, "sphere");
-            mc.setResolution(currentResolutionMC.yxz());
-            return mc;
+            static const tree::TreePointer cylinderTree = []()
+            {
+                ImplicitFieldPtr cylinder = std::make_shared<Cylinder>();
+                auto tree = std::make_shared<BlobTree>();
+                tree->insertField(cylinder);
+                tree->insertNodeTree({ { -1 } });
+                tree->insertFieldTree(cylinder);
+                return tree;
+            }();
+
+            return cylinderTree;
         }
 
-        polygonizer::Bsoid makePeanut()
+        tree::TreePointer makeConeTree()
         {
-            using atlas::math::Point;
-            using fields::Sphere;
-            using operators::Blend;
+            using fields::Cone;
 
-            ImplicitFieldPtr sphere1 =
-                std::make_shared<Sphere>(1.0f, Point(1.0f, 0, 0));
-            ImplicitFieldPtr sphere2 =
-                std::make_shared<Sphere>(1.0f, Point(-1.0f, 0, 0));
-            ImplicitOperatorPtr blend = std::make_shared<Blend>();
-            blend->insertFields({ sphere1, sphere2 });
-
-            BlobTree tree;
-            tree.insertFields({ sphere1, sphere2, blend });
-            tree.insertNodeTree({ { -1 }, { -1 }, { 0, 1 } });
-            tree.insertFieldTree(blend);
-
-            Bsoid soid(tree, "peanut");
-            soid.setSlicingAxis(SlicingAxes::XAxis);
-            soid.setNumCrossSections(std::get<0>(currentResolution));
-            soid.makeCrossSections(std::get<1>(currentResolution),
-                std::get<2>(currentResolution));
-            return soid;
+            static const tree::TreePointer coneTree = []()
+            {
+                ImplicitFieldPtr cone = std::make_shared<Cone>();
+                auto tree = std::make_shared<BlobTree>();
+                tree->insertField(cone);
+                tree->insertNodeTree({ { -1 } });
+                tree->insertFieldTree(cone);
+                return tree;
+            }();
+
+            return coneTree;
         }
 
-        polygonizer::MarchingCubes makeMCPeanut()
+        tree::TreePointer makeTorusTree()
+        {
+            using fields::Torus;
+
+            static const tree::TreePointer torusTree = []()
+            {
+                ImplicitFieldPtr torus = std::make_shared<Torus>();
+                auto tree = std::make_shared<BlobTree>();
+                tree->insertField(torus);
+                tree->insertNodeTree({ { -1 } });
+                tree->insertFieldTree(torus);
+                return tree;
+            }();
+
+            return torusTree;
+        }
+
+        tree::TreePointer makeChainTree()
         {
             using atlas::math::Point;
             using fields::Sphere;
             using operators::Blend;
 
-            ImplicitFieldPtr sphere1 =
-                std::make_shared<Sphere>(1.0f, Point(1.0f, 0, 0));
-            ImplicitFieldPtr sphere2 =
-                std::make_shared<Sphere>(1.0f, Point(-1.0f, 0, 0));
-            ImplicitOperatorPtr blend = std::make_shared<Blend>();
-            blend->insertFields({ sphere1, sphere2 });
+            static const tree::TreePointer chainTree = []()
+            {
+                static constexpr auto chainLength = 20;
+
+                std::vector<ImplicitFieldPtr> chain;
+                std::vector<std::vector<int>> nodes;
+
+                for (int i = 0; i < chainLength; ++i)
+                {
+                    chain.emplace_back(std::make_shared<Sphere>(1.0f,
+                        Point(-10.0f + 2.0f * i, 0, 0)));
+                    nodes.push_back({ -1 });
+                }
+
+                ImplicitOperatorPtr blend = std::make_shared<Blend>();
+                blend->insertFields(chain);
+
+                std::vector<int> roots(chainLength);
+                std::iota(roots.begin(), roots.end(), 0);
+                nodes.push_back(roots);
+                chain.push_back(blend);
+
+                auto tree = std::make_shared<BlobTree>();
+                tree->insertFields(chain);
+                tree->insertNodeTree(nodes);
+                tree->insertFieldTree(blend);
+                return tree;
+            }();
+
+            return chainTree;
+        }
 
-            BlobTree tree;
-            tree.insertFields({ sphere1, sphere2, blend });
-            tree.insertNodeTree({ { -1 }, { -1 }, { 0, 1 } });
-            tree.insertFieldTree(blend);
+        Resolution getResolution(ModelResolution res)
+        {
+            switch (res)
+            {
+            case ModelResolution::Low:
+                return lowResolution;
 
-            MarchingCubes mc(tree, "peanut");
-            mc.setResolution(currentResolutionMC.xyz());
+            case ModelResolution::Mid:
+                return midResolution;
 
-            return mc;
+            default:
+                return highResolution;
+            }
         }
 
-        polygonizer::Bsoid makeCylinder()
+        MCResolution getResolutionMC(ModelResolution res)
         {
-            using atlas::math::Point;
-            using fields::Cylinder;
+            switch (res)
+            {
+            case ModelResolution::Low:
+                return lowResolutionMC;
 
-            ImplicitFieldPtr cylinder = std::make_shared<Cylinder>();
-            BlobTree tree;
-            tree.insertField(cylinder);
-            tree.insertNodeTree({ { -1 } });
-            tree.insertFieldTree(cylinder);
-
-            Bsoid soid(tree, "cylinder");
-            soid.setSlicingAxis(SlicingAxes::ZAxis);
-            soid.setNumCrossSections(std::get<0>(currentResolution));
-            soid.makeCrossSections(std::get<1>(currentResolution),
-                std::get<2>(currentResolution));
-            return soid;
+            case ModelResolution::Mid:
+                return midResolutionMC;
+
+            default:
+                return highResolutionMC;
+            }
         }
-        
-        polygonizer::MarchingCubes makeMCCylinder()
+
+        Bsoid makeSoid(tree::TreePointer const& tree, std::string const& name,
+            SlicingAxes axis, ModelResolution res)
         {
-            using atlas::math::Point;
-            using fields::Cylinder;
+            auto resolution = getResolution(res);
+            Bsoid soid(tree, name);
+            soid.setSlicingAxis(axis);
+            soid.setNumCrossSections(std::get<0>(resolution));
+            soid.makeCrossSections(std::get<1>(resolution),
+                std::get<2>(resolution));
+            return soid;
+        }
 
-            ImplicitFieldPtr cylinder = std::make_shared<Cylinder>();
-            BlobTree tree;
-            tree.insertField(cylinder);
-            tree.insertNodeTree({ { -1 } });
-            tree.insertFieldTree(cylinder);
+        polygonizer::Bsoid makeSphere()
+        {
+            return makeSoid(makeSphereTree(), "sphere", SlicingAxes::YAxis,
+                currentResolution);
+        }
 
-            MarchingCubes mc(tree, "cylinder");
-            mc.setResolution(currentResolutionMC.zyx());
+        polygonizer::MarchingCubes makeMCSphere()
+        {
+            MarchingCubes mc(makeSphereTree(), "sphere");
+            mc.setResolution(getResolutionMC(currentResolution).yxz());
             return mc;
         }
 
-        polygonizer::Bsoid makeCone()
+        polygonizer::Bsoid makePeanut()
         {
-            using atlas::math::Point;
-            using fields::Cone;
+            return makeSoid(makePeanutTree(), "peanut", SlicingAxes::XAxis,
+                currentResolution);
+        }
 
-            ImplicitFieldPtr cone = std::make_shared<Cone>();
-            BlobTree tree;
-            tree.insertField(cone);
-            tree.insertNodeTree({ { -1 } });
-            tree.insertFieldTree(cone);
-
-            Bsoid soid(tree, "cone");
-            soid.setSlicingAxis(SlicingAxes::ZAxis);
-            soid.setNumCrossSections(std::get<0>(currentResolution));
-            soid.makeCrossSections(std::get<1>(currentResolution),
-                std::get<2>(currentResolution));
-            return soid;
+        polygonizer::MarchingCubes makeMCPeanut()
+        {
+            MarchingCubes mc(makePeanutTree(), "peanut");
+            mc.setResolution(getResolutionMC(currentResolution).xyz());
+            return mc;
         }
 
-        polygonizer::MarchingCubes makeMCCone()
+        polygonizer::Bsoid makeCylinder()
         {
-            using atlas::math::Point;
-            using fields::Cone;
+            return makeSoid(makeCylinderTree(), "cylinder", SlicingAxes::ZAxis,
+                currentResolution);
+        }
+
+        polygonizer::MarchingCubes makeMCCylinder()
+        {
+            MarchingCubes mc(makeCylinderTree(), "cylinder");
+            mc.setResolution(getResolutionMC(currentResolution).zyx());
+            return mc;
+        }
 
-            ImplicitFieldPtr cone = std::make_shared<Cone>();
-            BlobTree tree;
-            tree.insertField(cone);
-            tree.insertNodeTree({ { -1 } });
-            tree.insertFieldTree(cone);
+        polygonizer::Bsoid makeCone()
+        {
+            return makeSoid(makeConeTree(), "cone", SlicingAxes::ZAxis,
+                currentResolution);
+        }
 
-            MarchingCubes mc(tree, "cone");
-            mc.setResolution(currentResolutionMC.zyx());
+        polygonizer::MarchingCubes makeMCCone()
+        {
+            MarchingCubes mc(makeConeTree(), "cone");
+            mc.setResolution(getResolutionMC(currentResolution).zyx());
             return mc;
         }
 
         polygonizer::Bsoid makeTorus()
         {
-            using atlas::math::Point;
-            using fields::Torus;
-
-            ImplicitFieldPtr torus = std::make_shared<Torus>();
-            BlobTree tree;
-            tree.insertField(torus);
-            tree.insertNodeTree({ { -1 } });
-            tree.insertFieldTree(torus);
-
-            Bsoid soid(tree, "torus");
-            soid.setSlicingAxis(SlicingAxes::ZAxis);
-            soid.setNumCrossSections(std::get<0>(currentResolution));
-            soid.makeCrossSections(std::get<1>(currentResolution),
-                std::get<2>(currentResolution));
-            return soid;
+            return makeSoid(makeTorusTree(), "torus", SlicingAxes::ZAxis,
+                currentResolution);
         }
 
         polygonizer::MarchingCubes makeMCTorus()
         {
-            using atlas::math::Point;
-            using fields::Torus;
-
-            ImplicitFieldPtr torus = std::make_shared<Torus>();
-            BlobTree tree;
-            tree.insertField(torus);
-            tree.insertNodeTree({ { -1 } });
-            tree.insertFieldTree(torus);
-
-            MarchingCubes mc(tree, "torus");
-            mc.setResolution(currentResolutionMC.yxz());
+            MarchingCubes mc(makeTorusTree(), "torus");
+            mc.setResolution(getResolutionMC(currentResolution).yxz());
             return mc;
         }
 
         polygonizer::Bsoid makeChain()
         {
-            using atlas::math::Point;
-            using fields::Sphere;
-            using operators::Blend;
-
-            static constexpr auto chainLength = 20;
-
-            std::vector<ImplicitFieldPtr> chain;
-            std::vector<std::vector<int>> nodes;
-
-            for (int i = 0; i < chainLength; ++i)
-            {
-                chain.emplace_back(std::make_shared<Sphere>(1.0f,
-                    Point(-10.0f + 2.0f * i, 0, 0)));
-                nodes.push_back({ -1 });
-            }
-
-            ImplicitOperatorPtr blend = std::make_shared<Blend>();
-            blend->insertFields(chain);
-
-            std::vector<int> roots(chainLength);
-            std::iota(roots.begin(), roots.end(), 0);
-            nodes.push_back(roots);
-            chain.push_back(blend);
-
-            BlobTree tree;
-            tree.insertFields(chain);
-            tree.insertNodeTree(nodes);
-            tree.insertFieldTree(blend);
-
-            Bsoid soid(tree, "chain");
-            soid.setSlicingAxis(SlicingAxes::XAxis);
-            soid.setNumCrossSections(std::get<0>(currentResolution));
-            soid.makeCrossSections(std::get<1>(currentResolution),
-                std::get<2>(currentResolution));
-            return soid;
+            return makeSoid(makeChainTree(), "chain", SlicingAxes::XAxis,
+                currentResolution);
         }
 
         polygonizer::MarchingCubes makeMCChain()
         {
-            using atlas::math::Point;
-            using fields::Sphere;
-            using operators::Blend;
-
-            static constexpr auto chainLength = 20;
-
-            std::vector<ImplicitFieldPtr> chain;
-            std::vector<std::vector<int>> nodes;
-
-            for (int i = 0; i < chainLength; ++i)
-            {
-                chain.emplace_back(std::make_shared<Sphere>(1.0f,
-                    Point(-10.0f + 2.0f * i, 0, 0)));
-                nodes.push_back({ -1 });
-            }
-
-            ImplicitOperatorPtr blend = std::make_shared<Blend>();
-            blend->insertFields(chain);
-
-            std::vector<int> roots(chainLength);
-            std::iota(roots.begin(), roots.end(), 0);
-            nodes.push_back(roots);
-            chain.push_back(blend);
-
-            BlobTree tree;
-            tree.insertFields(chain);
-            tree.insertNodeTree(nodes);
-            tree.insertFieldTree(blend);
-
-            MarchingCubes mc(tree, "chain");
-            mc.setResolution(currentResolutionMC.yxz());
+            MarchingCubes mc(makeChainTree(), "chain");
+            mc.setResolution(getResolutionMC(currentResolution).yxz());
             return mc;
         }
+
+        std::vector<ModelEntry> getModelCatalog()
+        {
+            // Same set of models that main polygonizes.
+            std::vector<ModelEntry> catalog;
+
+            catalog.push_back({ "sphere",
+                [](ModelResolution res)
+                {
+                    return makeSoid(makeSphereTree(), "sphere", SlicingAxes::YAxis,
+                        res);
+                },
+                [](ModelResolution res)
+                {
+                    MarchingCubes mc(makeSphereTree(), "sphere");
+                    mc.setResolution(getResolutionMC(res).yxz());
+                    return mc;
+                } });
+
+            catalog.push_back({ "peanut",
+                [](ModelResolution res)
+                {
+                    return makeSoid(makePeanutTree(), "peanut", SlicingAxes::XAxis,
+                        res);
+                },
+                [](ModelResolution res)
+                {
+                    MarchingCubes mc(makePeanutTree(), "peanut");
+                    mc.setResolution(getResolutionMC(res).xyz());
+                    return mc;
+                } });
+
+            catalog.push_back({ "torus",
+                [](ModelResolution res)
+                {
+                    return makeSoid(makeTorusTree(), "torus", SlicingAxes::ZAxis,
+                        res);
+                },
+                [](ModelResolution res)
+                {
+                    MarchingCubes mc(makeTorusTree(), "torus");
+                    mc.setResolution(getResolutionMC(res).yxz());
+                    return mc;
+                } });
+
+            catalog.push_back({ "chain",
+                [](ModelResolution res)
+                {
+                    return makeSoid(makeChainTree(), "chain", SlicingAxes::XAxis,
+                        res);
+                },
+                [](ModelResolution res)
+                {
+                    MarchingCubes mc(makeChainTree(), "chain");
+                    mc.setResolution(getResolutionMC(res).yxz());
+                    return mc;
+                } });
+
+            return catalog;
+        }
     }
-}
\ No newline at end of file
+}
@@ -120,6 +120,16 @@ namespace athena
             return mMesh;
         }
 
+        atlas::utils::Mesh BranchingManager::linkPair(
+            std::vector<std::vector<FieldPoint>> const& top,
+            std::vector<std::vector<FieldPoint>> const& bottom)
+        {
+            BranchingManager manager;
+            manager.insertContours(top);
+            manager.insertContours(bottom);
+            return manager.connectContours();
+        }
+
         void BranchingManager::singleBranch(Slice const& top, Slice const& bottom)
         {
             auto topRing = top[0];
@@ -7,11 +7,17 @@
 #include <atlas/core/Log.hpp>
 #include <atlas/core/Float.hpp>
 
+#include <algorithm>
 #include <numeric>
 #include <functional>
 #include <unordered_set>
 #include <fstream>
 
+#if defined(ATHENA_PARALLEL)
+#include <tbb/parallel_for.h>
+#include <tbb/flow_graph.h>
+#endif
+
 #if defined ATLAS_DEBUG
 #define ATHENA_DEBUG_CONTOURS 0 
 
@@ -32,13 +38,32 @@ namespace athena
     namespace polygonizer
     {
         Bsoid::Bsoid() :
+            mRootFinder(RootFinder::Linear),
+            mRootTolerance(1.0e-4f),
+            mMaxRootIterations(8),
+            mPipelined(false),
             mName("model")
         { }
 
+        Bsoid::Bsoid(tree::TreePointer const& model, std::string const& name,
+            float isoValue) :
+            mTree(model),
+            mMagic(isoValue),
+            mRootFinder(RootFinder::Linear),
+            mRootTolerance(1.0e-4f),
+            mMaxRootIterations(8),
+            mPipelined(false),
+            mName(name)
+        { }
+
         Bsoid::Bsoid(tree::BlobTree const& model, std::string const& name,
             float isoValue) :
-            mTree(std::make_unique<tree::BlobTree>(model)),
+            mTree(std::make_shared<tree::BlobTree const>(model)),
             mMagic(isoValue),
+            mRootFinder(RootFinder::Linear),
+            mRootTolerance(1.0e-4f),
+            mMaxRootIterations(8),
+            mPipelined(false),
             mName(name)
         { }
 
@@ -49,20 +74,98 @@ namespace athena
             mCrossSectionDelta(b.mCrossSectionDelta),
             mAxis(b.mAxis),
             mCrossSections(std::move(b.mCrossSections)),
+            mBranchSections(std::move(b.mBranchSections)),
             mMesh(std::move(b.mMesh)),
             mMagic(b.mMagic),
+            mRootFinder(b.mRootFinder),
+            mRootTolerance(b.mRootTolerance),
+            mMaxRootIterations(b.mMaxRootIterations),
+            mUnprofiledTree(std::move(b.mUnprofiledTree)),
+            mProfiler(std::move(b.mProfiler)),
+            mPipelined(b.mPipelined),
             mLog(std::move(b.mLog)),
             mName(b.mName)
         { }
 
+        void Bsoid::setModel(tree::TreePointer const& model)
+        {
+            mTree = model;
+            mUnprofiledTree.reset();
+            mProfiler.reset();
+        }
+
         void Bsoid::setModel(tree::BlobTree const& model)
         {
-            mTree = std::make_unique<tree::BlobTree>(model);
+            setModel(std::make_shared<tree::BlobTree const>(model));
         }
 
         void Bsoid::setIsoValue(float isoValue)
         {
+            // The sections keep their field samples, so the next
+            // polygonize only re-marches them at the new value.
             mMagic = isoValue;
+            for (auto& section : mCrossSections)
+            {
+                if (section)
+                {
+                    section->setIsoValue(isoValue);
+                }
+            }
+        }
+
+        float Bsoid::isoValue() const
+        {
+            return mMagic;
+        }
+
+        void Bsoid::setRootFinder(RootFinder method, float tolerance,
+            std::size_t maxIterations)
+        {
+            mRootFinder = method;
+            mRootTolerance = tolerance;
+            mMaxRootIterations = maxIterations;
+
+            for (auto& section : mCrossSections)
+            {
+                if (section)
+                {
+                    section->setRootFinder(method, tolerance, maxIterations);
+                }
+            }
+        }
+
+        void Bsoid::setProfiling(bool enabled)
+        {
+            if (enabled == static_cast<bool>(mProfiler))
+            {
+                return;
+            }
+
+            if (enabled)
+            {
+                mProfiler = std::make_shared<fields::FieldProfiler>();
+                mUnprofiledTree = mTree;
+                mTree = mUnprofiledTree->makeProfiled(*mProfiler);
+            }
+            else
+            {
+                mTree = mUnprofiledTree;
+                mUnprofiledTree.reset();
+                mProfiler.reset();
+            }
+
+            // The sections hold on to the tree they were made with, so they
+            // have to be made again.
+            if (!mCrossSections.empty() && mCrossSections.front())
+            {
+                auto res = mCrossSections.front()->getResolutions();
+                makeCrossSections(res.first, res.second);
+            }
+        }
+
+        void Bsoid::setPipelined(bool enabled)
+        {
+            mPipelined = enabled;
         }
 
         void Bsoid::setSlicingAxis(SlicingAxes const& axis)
@@ -94,6 +197,7 @@ namespace athena
 
             // Resize the vector here.
             mCrossSectionDelta = delta;
+            removeBranchSections();
             mCrossSections.resize(numSlices);
         }
 
@@ -116,6 +220,7 @@ namespace athena
                 break;
             }
 
+            removeBranchSections();
             mCrossSections.resize(num);
         }
 
@@ -134,9 +239,9 @@ namespace athena
             return mAxis;
         }
 
-        tree::BlobTree* Bsoid::tree() const
+        tree::TreePointer const& Bsoid::tree() const
         {
-            return mTree.get();
+            return mTree;
         }
 
         void Bsoid::makeCrossSections(std::uint32_t gridSize, 
@@ -144,6 +249,7 @@ namespace athena
         {
             using atlas::math::Point;
 
+            removeBranchSections();
             if (mCrossSections.empty())
             {
                 return;
@@ -177,6 +283,8 @@ namespace athena
             {
                 mCrossSections[i] = std::make_unique<CrossSection>(
                     mAxis, min, max, gridSize, svSize, mMagic, mTree.get());
+                mCrossSections[i]->setRootFinder(mRootFinder, mRootTolerance,
+                    mMaxRootIterations);
 
                 switch (mAxis)
                 {
@@ -218,61 +326,51 @@ namespace athena
             mCrossSections[mCrossSections.size() - 1] =
                 std::make_unique<CrossSection>(mAxis, min, max, gridSize, svSize,
                     mMagic, mTree.get());
+            mCrossSections.back()->setRootFinder(mRootFinder, mRootTolerance,
+                mMaxRootIterations);
         }
 
         void Bsoid::constructLattices()
         {
             atlas::core::Timer<float> global;
             atlas::core::Timer<float> t;
-            int i = 0;
             global.start();
-            // This can be done in parallel.
-            for (auto& section : mCrossSections)
+            removeBranchSections();
+            forEachSection([](CrossSection& section)
             {
-#if defined (ATLAS_DEBUG) && (ATHENA_DEBUG_CONTOURS)
-                ATHENA_DEBUG_CONTOUR_RANGE(i, ATHENA_DEBUG_CONTOUR_START,
-                    ATHENA_DEBUG_CONTOUR_END);
-#endif
-                section->constructLattice();
-                ++i;
-            }
+                section.constructLattice();
+            });
 
-            std::vector<std::vector<Voxel>> voxels;
-            i = 0;
+            std::vector<std::vector<Voxel> const*> voxels;
+            std::vector<PointPool const*> points;
+            int i = 0;
             for (auto& section : mCrossSections)
             {
 #if defined (ATLAS_DEBUG) && (ATHENA_DEBUG_CONTOURS)
                 ATHENA_DEBUG_CONTOUR_RANGE(i, ATHENA_DEBUG_CONTOUR_START,
                     ATHENA_DEBUG_CONTOUR_END);
 #endif
-                voxels.push_back(section->getVoxels());
+                voxels.push_back(&section->getVoxels());
+                points.push_back(&section->getPoints());
                 ++i;
             }
 
-            mLattice.makeLattice(voxels);
+            mLattice.makeLattice(voxels, points);
         }
         
         void Bsoid::constructContours()
         {
             atlas::core::Timer<float> global;
             atlas::core::Timer<float> t;
-            int i = 0;
             global.start();
-
-            // This can be done in parallel. I think...
-            for (auto& section : mCrossSections)
+            forEachSection([](CrossSection& section)
             {
-#if defined (ATLAS_DEBUG) && (ATHENA_DEBUG_CONTOURS)
-                ATHENA_DEBUG_CONTOUR_RANGE(i, ATHENA_DEBUG_CONTOUR_START,
-                    ATHENA_DEBUG_CONTOUR_END);
-#endif
-                 section->constructContour();
-                ++i;
-            }
+                section.constructContour();
+            });
 
             // Something here to create the contour thing.
             std::vector<std::vector<std::vector<FieldPoint>>> contours;
-            i = 0;
+            int i = 0;
             for (auto& section : mCrossSections)
             {
 #if defined (ATLAS_DEBUG) && (ATHENA_DEBUG_CONTOURS)
@@ -294,6 +392,10 @@ namespace athena
             atlas::core::Timer<float> global;
             atlas::core::Timer<float> t;
 
+            // Sections from an earlier call would otherwise be linked again
+            // and counted as branches of their own.
+            removeBranchSections();
+
             // First we need to subdivide the contours into the largest
             // size that we have. Simulatenously grab the number of conours
             // per branch.
@@ -309,18 +411,11 @@ namespace athena
                 }
             }
 
-            // Now that we have it, lets resize all of the contours. Again
-            // this can be done in parallel.
-            int i = 0;
-            for (auto& section : mCrossSections)
+            // Now that we have it, lets resize all of the contours.
+            forEachSection([maxContourSize](CrossSection& section)
             {
-#if defined (ATLAS_DEBUG) && (ATHENA_DEBUG_CONTOURS)
-                ATHENA_DEBUG_CONTOUR_RANGE(i, ATHENA_DEBUG_CONTOUR_START,
-                    ATHENA_DEBUG_CONTOUR_END);
-#endif
-                section->resizeContours(maxContourSize);
-                ++i;
-            }
+                section.resizeContours(maxContourSize);
+            });
 
             // Now we have the branching manager tell us which layers need to 
             // be processed for branching.
@@ -400,9 +495,12 @@ namespace athena
                         auto res = bottom->getResolutions();
                         auto cs = std::make_unique<CrossSection>(mAxis, min, max,
                             res.first, res.second, mMagic, mTree.get());
+                        cs->setRootFinder(mRootFinder, mRootTolerance,
+                            mMaxRootIterations);
                         cs->constructLattice();
                         cs->constructContour();
                         cs->resizeContours(maxContourSize);
+                        mBranchSections.push_back(cs.get());
                         mCrossSections.insert(
                             mCrossSections.begin() + branchCase.top,
                             std::move(cs));
@@ -424,19 +522,21 @@ namespace athena
 
             mMesh = manager.connectContours();
 
-            std::vector<std::vector<Voxel>> voxels;
-            i = 0;
+            std::vector<std::vector<Voxel> const*> voxels;
+            std::vector<PointPool const*> points;
+            int i = 0;
             for (auto& section : mCrossSections)
             {
 #if defined(ATLAS_DEBUG) && (ATHENA_DEBUG_CONTOURS)
                 ATHENA_DEBUG_CONTOUR_RANGE(i, ATHENA_DEBUG_CONTOUR_START,
                     ATHENA_DEBUG_CONTOUR_END);
 #endif
-                voxels.push_back(section->getVoxels());
+                voxels.push_back(&section->getVoxels());
+                points.push_back(&section->getPoints());
                 ++i;
             }
 
-            mLattice.makeLattice(voxels);
+            mLattice.makeLattice(voxels, points);
 
             std::vector<std::vector<std::vector<FieldPoint>>> contours;
             i = 0;
@@ -453,45 +553,50 @@ namespace athena
             mContour.makeContour(contours);
         }
 
-        void Bsoid::polygonize()
+        PolygonizerStats Bsoid::polygonize()
         {
             using atlas::core::Timer;
 
+            if (mPipelined)
+            {
+                return polygonizePipelined();
+            }
+
+            PolygonizerStats stats;
             Timer<float> global;
 
+            if (mProfiler)
+            {
+                mProfiler->clear();
+            }
+
             global.start();
             // Generate lattices.
             {
                 Timer<float> step;
-                Timer<float> part;
                 step.start();
-                int i = 0;
-                for (auto& section : mCrossSections)
+                forEachSection([](CrossSection& section)
                 {
-                    section->constructLattice();
-                    ++i;
-                }
+                    section.constructLattice();
+                });
 
-                auto stepElapsed = step.elapsed();
+                stats.stages.push_back({ "lattice", step.elapsed() });
             }
 
             // Generate contours.
             {
                 Timer<float> step;
-                Timer<float> part;
                 step.start();
-                int i = 0;
-                for (auto& section : mCrossSections)
+                forEachSection([](CrossSection& section)
                 {
-                    section->constructContour();
-                    ++i;
-                }
+                    section.constructContour();
+                });
+
+                stats.stages.push_back({ "contour", step.elapsed() });
             }
 
             {
                 Timer<float> step;
-                Timer<float> part;
-
                 step.start();
 
                 std::size_t size = 0;
@@ -503,13 +608,18 @@ namespace athena
                     }
                 }
 
-                int i = 0;
                 INFO_LOG_V("Maximal size: %d", size);
-                for (auto& section : mCrossSections)
+                forEachSection([size](CrossSection& section)
                 {
-                    section->resizeContours(size);
-                    i++;
-                }
+                    section.resizeContours(size);
+                });
+
+                stats.stages.push_back({ "resize", step.elapsed() });
+            }
+
+            {
+                Timer<float> step;
+                step.start();
 
                 // Once we have all of the contour data, send it down to the manager
                 // for linking.
@@ -521,14 +631,293 @@ namespace athena
 
                 mMesh = manager.connectContours();
 
-                auto stepElapsed = step.elapsed();
+                stats.stages.push_back({ "link", step.elapsed() });
+            }
+
+            stats.total = global.elapsed();
+            stats.vertices = mMesh.vertices().size();
+
+            // Every lattice point is sampled exactly once, the rest of the
+            // evaluations come from finding the iso-crossings.
+            std::size_t evaluations = 0;
+            for (auto& section : mCrossSections)
+            {
+                evaluations += section->getNumRootEvaluations();
+                stats.fieldEvaluations += section->getNumFieldSamples();
+                ATHENA_STATS(stats.sections.push_back(section->getStats()));
+            }
+            stats.fieldEvaluations += evaluations;
+
+            logSummary(stats, evaluations, "");
+            return stats;
+        }
+
+        PolygonizerStats Bsoid::polygonizeStreaming(MeshSink const& sink)
+        {
+            using atlas::core::Timer;
+
+            PolygonizerStats stats;
+            stats.stages =
+            {
+                { "lattice", 0.0f }, { "contour", 0.0f }, { "resize", 0.0f },
+                { "link", 0.0f }
+            };
+            Timer<float> global;
+
+            if (mProfiler)
+            {
+                mProfiler->clear();
             }
 
+            global.start();
+
+            std::size_t evaluations = 0;
+            auto retire = [&stats, &evaluations](CrossSection& section)
+            {
+                evaluations += section.getNumRootEvaluations();
+                stats.fieldEvaluations += section.getNumFieldSamples();
+                ATHENA_STATS(stats.sections.push_back(section.getStats()));
+                section.release();
+            };
+
+            for (std::size_t i = 0; i < mCrossSections.size(); ++i)
+            {
+                auto& section = *mCrossSections[i];
+                {
+                    Timer<float> step;
+                    step.start();
+                    section.constructLattice();
+                    stats.stages[0].time += step.elapsed();
+                }
+
+                {
+                    Timer<float> step;
+                    step.start();
+                    section.constructContour();
+                    stats.stages[1].time += step.elapsed();
+                }
+
+                if (i == 0)
+                {
+                    continue;
+                }
+
+                // Without the global maximum, each pair is resampled to the
+                // larger of its two slices so their contours still match.
+                auto& previous = *mCrossSections[i - 1];
+                std::vector<std::vector<FieldPoint>> top, bottom;
+                {
+                    Timer<float> step;
+                    step.start();
+                    auto size = std::max(previous.getLargestContourSize(),
+                        section.getLargestContourSize());
+                    top = previous.resampleContours(size);
+                    bottom = section.resampleContours(size);
+                    stats.stages[2].time += step.elapsed();
+                }
+
+                atlas::utils::Mesh strip;
+                {
+                    Timer<float> step;
+                    step.start();
+                    strip = BranchingManager::linkPair(top, bottom);
+                    stats.stages[3].time += step.elapsed();
+                }
+
+                stats.vertices += strip.vertices().size();
+                sink(strip);
+                retire(previous);
+            }
+
+            if (!mCrossSections.empty())
+            {
+                retire(*mCrossSections.back());
+            }
+
+            stats.total = global.elapsed();
+            stats.fieldEvaluations += evaluations;
+
+            logSummary(stats, evaluations, "streaming");
+            return stats;
+        }
+
+        PolygonizerStats Bsoid::polygonizePipelined()
+        {
+            using atlas::core::Timer;
+
+            PolygonizerStats stats;
+            Timer<float> global;
+
+            if (mProfiler)
+            {
+                mProfiler->clear();
+            }
+
+            global.start();
+
+            // The tasks overlap, so each one keeps its own time and the
+            // stages report the sum over all slices and pairs rather than
+            // wall time.
+            std::size_t numSlices = mCrossSections.size();
+            std::size_t numPairs = (numSlices > 0) ? numSlices - 1 : 0;
+            std::vector<float> latticeTimes(numSlices, 0.0f);
+            std::vector<float> contourTimes(numSlices, 0.0f);
+            std::vector<float> resizeTimes(numPairs, 0.0f);
+            std::vector<float> linkTimes(numPairs, 0.0f);
+            std::vector<atlas::utils::Mesh> strips(numPairs);
+
+            auto buildSlice = [&](std::size_t i)
+            {
+                auto& section = *mCrossSections[i];
+                Timer<float> step;
+                step.start();
+                section.constructLattice();
+                latticeTimes[i] = step.elapsed();
+
+                step.start();
+                section.constructContour();
+                contourTimes[i] = step.elapsed();
+            };
+
+            // Links slice i to slice i + 1. Both are only read, so the pairs
+            // on either side of a slice can run at the same time.
+            auto linkSlices = [&](std::size_t i)
+            {
+                auto& top = *mCrossSections[i];
+                auto& bottom = *mCrossSections[i + 1];
+
+                Timer<float> step;
+                step.start();
+                auto size = std::max(top.getLargestContourSize(),
+                    bottom.getLargestContourSize());
+                auto topContours = top.resampleContours(size);
+                auto bottomContours = bottom.resampleContours(size);
+                resizeTimes[i] = step.elapsed();
+
+                step.start();
+                strips[i] = BranchingManager::linkPair(topContours,
+                    bottomContours);
+                linkTimes[i] = step.elapsed();
+            };
+
+#if defined(ATHENA_PARALLEL)
+            // A pair node has an edge from each of its slices, so it fires
+            // as soon as the second one is done.
+            using Node =
+                tbb::flow::continue_node<tbb::flow::continue_msg>;
+
+            tbb::flow::graph graph;
+            std::vector<std::unique_ptr<Node>> slices;
+            std::vector<std::unique_ptr<Node>> pairs;
+            for (std::size_t i = 0; i < numSlices; ++i)
+            {
+                slices.push_back(std::make_unique<Node>(graph,
+                    [&buildSlice, i](tbb::flow::continue_msg const&)
+                {
+                    buildSlice(i);
+                    return tbb::flow::continue_msg();
+                }));
+            }
+
+            for (std::size_t i = 0; i < numPairs; ++i)
+            {
+                pairs.push_back(std::make_unique<Node>(graph,
+                    [&linkSlices, i](tbb::flow::continue_msg const&)
+                {
+                    linkSlices(i);
+                    return tbb::flow::continue_msg();
+                }));
+                tbb::flow::make_edge(*slices[i], *pairs[i]);
+                tbb::flow::make_edge(*slices[i + 1], *pairs[i]);
+            }
+
+            for (auto& slice : slices)
+            {
+                slice->try_put(tbb::flow::continue_msg());
+            }
+            graph.wait_for_all();
+#else
+            for (std::size_t i = 0; i < numSlices; ++i)
+            {
+                buildSlice(i);
+                if (i > 0)
+                {
+                    linkSlices(i - 1);
+                }
+            }
+#endif
+
+            // Stitch the strips together in slice order.
+            Timer<float> step;
+            step.start();
+            mMesh = atlas::utils::Mesh();
+            for (auto& strip : strips)
+            {
+                auto offset = static_cast<std::uint32_t>(
+                    mMesh.vertices().size());
+                mMesh.vertices().insert(mMesh.vertices().end(),
+                    strip.vertices().begin(), strip.vertices().end());
+                mMesh.normals().insert(mMesh.normals().end(),
+                    strip.normals().begin(), strip.normals().end());
+                for (auto index : strip.indices())
+                {
+                    mMesh.indices().push_back(offset + index);
+                }
+            }
+            float merge = step.elapsed();
+
+            auto sum = [](std::vector<float> const& times)
+            {
+                return std::accumulate(times.begin(), times.end(), 0.0f);
+            };
+
+            stats.stages =
+            {
+                { "lattice", sum(latticeTimes) },
+                { "contour", sum(contourTimes) },
+                { "resize", sum(resizeTimes) },
+                { "link", sum(linkTimes) + merge }
+            };
+            stats.total = global.elapsed();
+            stats.vertices = mMesh.vertices().size();
+
+            std::size_t evaluations = 0;
+            for (auto& section : mCrossSections)
+            {
+                evaluations += section->getNumRootEvaluations();
+                stats.fieldEvaluations += section->getNumFieldSamples();
+                ATHENA_STATS(stats.sections.push_back(section->getStats()));
+            }
+            stats.fieldEvaluations += evaluations;
+
+            logSummary(stats, evaluations, "pipelined");
+            return stats;
+        }
+
+        void Bsoid::logSummary(PolygonizerStats const& stats,
+            std::size_t evaluations, std::string const& mode)
+        {
             mLog << "\nSummary: ";
-            mLog << mName + "\n";
+            mLog << mName;
+            if (!mode.empty())
+            {
+                mLog << " (" << mode << ")";
+            }
+            mLog << "\n";
             mLog << "#===========================#\n";
-            mLog << "Total runtime: " << global.elapsed() << " seconds\n";
-            mLog << "Total vertices generated: " << mMesh.vertices().size() << "\n";
+            mLog << "Total runtime: " << stats.total << " seconds\n";
+            mLog << "Total vertices generated: " << stats.vertices << "\n";
+            mLog << "Root finding evaluations: " << evaluations << "\n";
+            for (auto& stage : stats.stages)
+            {
+                mLog << "Stage " << stage.name << ": " << stage.time <<
+                    " seconds\n";
+            }
+
+            if (mProfiler)
+            {
+                mLog << mProfiler->report();
+            }
         }
 
         std::size_t Bsoid::getNumSlices() const
@@ -576,6 +965,53 @@ namespace athena
             mMesh.saveToFile(mName + ".obj");
         }
 
+        void Bsoid::removeBranchSections()
+        {
+            // The branch sections are placed from the contours of the
+            // others, so they only hold until those are built again.
+            if (mBranchSections.empty())
+            {
+                return;
+            }
+
+            auto isBranch = [this](CrossSectionPointer const& section)
+            {
+                return std::find(mBranchSections.begin(),
+                    mBranchSections.end(), section.get()) !=
+                    mBranchSections.end();
+            };
+
+            mCrossSections.erase(std::remove_if(mCrossSections.begin(),
+                mCrossSections.end(), isBranch), mCrossSections.end());
+            mBranchSections.clear();
+        }
+
+        void Bsoid::forEachSection(
+            std::function<void(CrossSection&)> const& fn)
+        {
+            // Slices don't depend on each other until they are linked, so
+            // each one can be its own task. The debug range needs to skip
+            // sections in order, so keep that one serial.
+#if defined(ATHENA_PARALLEL) && !(defined(ATLAS_DEBUG) && (ATHENA_DEBUG_CONTOURS))
+            tbb::parallel_for(std::size_t(0), mCrossSections.size(),
+                [this, &fn](std::size_t i)
+            {
+                fn(*mCrossSections[i]);
+            });
+#else
+            int i = 0;
+            for (auto& section : mCrossSections)
+            {
+#if defined (ATLAS_DEBUG) && (ATHENA_DEBUG_CONTOURS)
+                ATHENA_DEBUG_CONTOUR_RANGE(i, ATHENA_DEBUG_CONTOUR_START,
+                    ATHENA_DEBUG_CONTOUR_END);
+#endif
+                fn(*section);
+                ++i;
+            }
+#endif
+        }
+
         void Bsoid::connectContours()
         {
             // We are going to process each pair of contours to generate the 
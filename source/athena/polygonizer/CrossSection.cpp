@@ -6,12 +6,19 @@
 #include <atlas/core/Float.hpp>
 #include <atlas/core/Log.hpp>
 #include <atlas/core/Assert.hpp>
+#include <atlas/core/Timer.hpp>
 
+#include <algorithm>
 #include <map>
+#include <numeric>
 #include <unordered_map>
 #include <unordered_set>
 #include <queue>
 
+#if defined(ATHENA_PARALLEL)
+#include <tbb/parallel_for.h>
+#endif
+
 #if defined ATLAS_DEBUG
 #define ATHENA_DEBUG_CONTOURS 0 
 #endif
@@ -23,16 +30,22 @@ namespace athena
         CrossSection::CrossSection(SlicingAxes const& axis, 
             atlas::math::Point const& min, atlas::math::Point const& max, 
             std::uint32_t gridSize, std::uint32_t svSize, float isoValue,
-            tree::BlobTree* tree) :
+            tree::BlobTree const* tree) :
             mMin(min),
             mMax(max),
             mGridSize(gridSize),
             mSvSize(svSize),
             mMagic(isoValue),
             mShadowMagic(0.1f),
+            mRootFinder(RootFinder::Linear),
+            mRootTolerance(1.0e-4f),
+            mMaxRootIterations(8),
+            mRootEvaluations(0),
+            mPointsBeforeLattice(0),
             mTree(tree),
             mAxis(axis),
-            mLargestContourSize(0)
+            mLargestContourSize(0),
+            mHasSamples(false)
         {
             using atlas::math::Normal;
 
@@ -70,54 +83,107 @@ namespace athena
 
         void CrossSection::constructLattice()
         {
+#if defined(ATHENA_STATS_ENABLED)
+            atlas::core::Timer<float> timer;
+            timer.start();
+            mStats = SectionStats();
+#endif
+
+            // Samples kept from an earlier call aren't evaluated again, so
+            // only the ones added from here on count.
+            mRootEvaluations = 0;
+            mPointsBeforeLattice = (mHasSamples) ? mPoints.size() : 0;
+            if (!mHasSamples)
+            {
+                sampleField();
+            }
+
+            // Everything below depends on the iso-value. The field samples
+            // in the point cache don't, so they carry over between calls.
+            mSeenVoxels.reset(mGridSize);
+            mEdgeCache.clear();
+            mVoxels.clear();
+            mContours.clear();
+            mLargestContourSize = 0;
+
+            marchVoxelOnSurface(mSeedVoxels);
+            ATHENA_STATS(mStats.lattice = timer.elapsed());
+
+#if defined ATLAS_DEBUG
+            validateVoxels();
+#endif
+        }
+
+        void CrossSection::setIsoValue(float isoValue)
+        {
+            mMagic = isoValue;
+        }
+
+        void CrossSection::sampleField()
+        {
             using atlas::math::Point;
             using atlas::utils::BBox;
 
-            // Can should be done in parallel by having each super-voxel be a
-            // separate task.
-            for (std::uint32_t x = 0; x < mSvSize; ++x)
+            mSeenVoxelPoints.reset(mGridSize);
+            mPoints.clear();
+
+            // Each super-voxel writes only to its own slot, so the pruning
+            // can run with one task per cell.
+            mSuperVoxels.clear();
+            mSuperVoxels.resize(mSvSize * mSvSize);
+            auto pruneCell = [this](std::uint32_t x, std::uint32_t y)
             {
-                for (std::uint32_t y = 0; y < mSvSize; ++y)
-                {
-                    auto pt = createCellPoint(x, y, mSvDelta);
+                auto pt = createCellPoint(x, y, mSvDelta);
 
-                    // Construct the cell that corresponds to the super-voxel.
-                    BBox cell(pt, pt + mSvDelta);
+                // Construct the cell that corresponds to the super-voxel.
+                BBox cell(pt, pt + mSvDelta);
 
-                    SuperVoxel sv;
-                    sv.field = mTree->getSubTree(cell);
-                    sv.id = { x, y };
+                auto& sv = mSuperVoxels[superVoxelIndex(x, y)];
+                sv.field = mTree->getSubTree(cell);
+                sv.id = { x, y };
+                sv.cell = cell;
+            };
 
-                    if (sv.field)
-                    {
-                        auto idx = BsoidHash32::hash(x, y);
-                        mSuperVoxels[idx] = sv;
-                    }
+#if defined(ATHENA_PARALLEL)
+            tbb::parallel_for(std::uint32_t(0), mSvSize * mSvSize,
+                [this, &pruneCell](std::uint32_t i)
+            {
+                pruneCell(i / mSvSize, i % mSvSize);
+            });
+#else
+            for (std::uint32_t x = 0; x < mSvSize; ++x)
+            {
+                for (std::uint32_t y = 0; y < mSvSize; ++y)
+                {
+                    pruneCell(x, y);
                 }
             }
+#endif
 
             // This can also be done in parallel (provided the number of seeds
             // is sufficiently large (could be based on the number of cores).
             auto seedPoints = mTree->getSeeds(mNormal);
-            std::vector<Voxel> seedVoxels;
+            mSeedVoxels.clear();
             for (auto& pt : seedPoints)
             {
                 auto v = (pt - mMin) / mGridDelta;
                 PointId id;
                 id.x = static_cast<std::uint32_t>(v[mAxisId.x]);
                 id.y = static_cast<std::uint32_t>(v[mAxisId.y]);
-                seedVoxels.emplace_back(id);
+                mSeedVoxels.emplace_back(id);
             }
 
-            marchVoxelOnSurface(seedVoxels);
-
-#if defined ATLAS_DEBUG
-            validateVoxels();
-#endif
+            mHasSamples = true;
         }
 
         void CrossSection::constructContour()
         {
+#if defined(ATHENA_STATS_ENABLED)
+            atlas::core::Timer<float> timer;
+            timer.start();
+            std::size_t evaluations = mRootEvaluations;
+#endif
+
             auto segments = generateLineSegments(mVoxels);
             auto contours = convertToContour(segments);
 
@@ -133,6 +199,11 @@ namespace athena
                }
            }
 
+           ATHENA_STATS(mStats.rootEvaluations +=
+               mRootEvaluations - evaluations);
+           ATHENA_STATS(mStats.contours = mContours.size());
+           ATHENA_STATS(mStats.contour = timer.elapsed());
+
 #if defined ATLAS_DEBUG
              validateContour();
 #endif
@@ -146,17 +217,129 @@ namespace athena
                 return;
             }
 
+#if defined(ATHENA_STATS_ENABLED)
+            atlas::core::Timer<float> timer;
+            timer.start();
+            std::size_t startEvaluations = mRootEvaluations;
+#endif
+
             // Now let's loop through our contours and see which ones
-            // need to be resized.
-            int i = 0;
-            for (auto& contour : mContours)
+            // need to be resized. Each contour only touches its own entry.
+            auto resize = [this, size](std::size_t i)
+            {
+                if (mContours[i].size() <= size)
+                {
+                    std::size_t evaluations = 0;
+                    mContours[i] = subdivideContour(mContours[i], size,
+                        evaluations);
+                    mRootEvaluations += evaluations;
+                }
+            };
+
+#if defined(ATHENA_PARALLEL)
+            tbb::parallel_for(static_cast<std::size_t>(0), mContours.size(),
+                resize);
+#else
+            for (std::size_t i = 0; i < mContours.size(); ++i)
+            {
+                resize(i);
+            }
+#endif
+
+            ATHENA_STATS(mStats.surfaceEvaluations +=
+                mRootEvaluations - startEvaluations);
+            ATHENA_STATS(mStats.resize = timer.elapsed());
+        }
+
+        std::vector<std::vector<FieldPoint>> CrossSection::resampleContours(
+            std::size_t size)
+        {
+            if (mLargestContourSize == 1)
+            {
+                return mContours;
+            }
+
+#if defined(ATHENA_STATS_ENABLED)
+            atlas::core::Timer<float> timer;
+            timer.start();
+#endif
+
+            // Count per contour rather than taking the difference of
+            // mRootEvaluations, which may be growing from another pair.
+            std::vector<std::vector<FieldPoint>> result(mContours.size());
+            std::vector<std::size_t> evaluations(mContours.size(), 0);
+            auto resample = [this, size, &result, &evaluations](std::size_t i)
             {
-                if (contour.size() <= size)
+                if (mContours[i].size() <= size)
+                {
+                    result[i] = subdivideContour(mContours[i], size,
+                        evaluations[i]);
+                    mRootEvaluations += evaluations[i];
+                }
+                else
                 {
-                    subdivideContour(i, size);
+                    result[i] = mContours[i];
                 }
-                ++i;
+            };
+
+#if defined(ATHENA_PARALLEL)
+            tbb::parallel_for(static_cast<std::size_t>(0), mContours.size(),
+                resample);
+#else
+            for (std::size_t i = 0; i < mContours.size(); ++i)
+            {
+                resample(i);
+            }
+#endif
+
+#if defined(ATHENA_STATS_ENABLED)
+            {
+                std::lock_guard<std::mutex> lock(mStatsMutex);
+                mStats.surfaceEvaluations += std::accumulate(
+                    evaluations.begin(), evaluations.end(), std::size_t(0));
+                mStats.resize += timer.elapsed();
             }
+#endif
+            return result;
+        }
+
+        void CrossSection::release()
+        {
+            // Assigning empty containers (instead of clearing them) is what
+            // actually gives the memory back.
+            mVoxels = std::vector<Voxel>();
+            mPoints = PointPool();
+            mContours = std::vector<std::vector<FieldPoint>>();
+            mSuperVoxels = std::vector<SuperVoxel>();
+            mSeenVoxelPoints = PointCache();
+            mSeenVoxels = VoxelSet();
+            mEdgeCache = EdgeCache();
+            mSeedVoxels = std::vector<Voxel>();
+            mLargestContourSize = 0;
+            mHasSamples = false;
+        }
+
+        void CrossSection::setRootFinder(RootFinder method, float tolerance,
+            std::size_t maxIterations)
+        {
+            mRootFinder = method;
+            mRootTolerance = tolerance;
+            mMaxRootIterations = maxIterations;
+        }
+
+        std::size_t CrossSection::getNumRootEvaluations() const
+        {
+            return mRootEvaluations;
+        }
+
+        std::size_t CrossSection::getNumFieldSamples() const
+        {
+            return mPoints.size() - mPointsBeforeLattice;
+        }
+
+        SectionStats const& CrossSection::getStats() const
+        {
+            return mStats;
         }
 
         std::vector<FieldPoint> CrossSection::findShadowPoints()
@@ -189,6 +372,11 @@ namespace athena
             return mVoxels;
         }
 
+        PointPool const& CrossSection::getPoints() const
+        {
+            return mPoints;
+        }
+
         std::vector<std::vector<FieldPoint>> const& 
             CrossSection::getContour() const
         {
@@ -230,17 +418,24 @@ namespace athena
             return createCellPoint(p.x, p.y, delta);
         }
 
-        FieldPoint CrossSection::findVoxelPoint(PointId const& id)
+        std::uint32_t CrossSection::superVoxelIndex(std::uint32_t x,
+            std::uint32_t y) const
+        {
+            return x * mSvSize + y;
+        }
+
+        std::uint32_t CrossSection::findVoxelPoint(PointId const& id)
         {
             using atlas::math::Point4;
             using atlas::math::Point;
 
             // First check if we have seen this point before.
-            auto entry = mSeenVoxelPoints.find(BsoidHash32::hash(id.x, id.y));
-            if (entry != mSeenVoxelPoints.end())
+            auto entry = mSeenVoxelPoints.find(id);
+            if (entry != invalidUint())
             {
                 // We have seen it, return the point.
-                return (*entry).second;
+                ATHENA_STATS(++mStats.pointCacheHits);
+                return entry;
             }
             else
             {
@@ -263,19 +458,18 @@ namespace athena
                 // Now that we have the id, let's evaluate the point.
                 FieldPoint fp;
                 {
-                    auto svHash = BsoidHash32::hash(svId.x, svId.y);
-                    SuperVoxel sv = mSuperVoxels[svHash];
-                    auto val = sv.eval(pt);
-                    auto g = sv.grad(pt);
-                    fp = { pt, val, g, svHash };
+                    auto svHash = superVoxelIndex(svId.x, svId.y);
+                    auto const& sv = mSuperVoxels[svHash];
+                    auto sample = sv.evalWithGradient(pt);
+                    fp = { pt, sample.value, sample.gradient, svHash };
+                    ATHENA_STATS(++mStats.fieldSamples);
                 }
 
                 // Now that we have the point, let's add it to our list and
                 // return it.
-                auto hash = BsoidHash32::hash(id.x, id.y);
-                mSeenVoxelPoints.insert(
-                    std::pair<std::uint32_t, FieldPoint>(hash, fp));
-                return fp;
+                auto index = mPoints.push_back(fp);
+                mSeenVoxelPoints.insert(id, index);
+                return index;
             }
         }
 
@@ -292,18 +486,7 @@ namespace athena
 
         bool CrossSection::seenVoxel(VoxelId const& id)
         {
-            if (mSeenVoxels.find(BsoidHash32::hash(id.x, id.y)) !=
-                mSeenVoxels.end())
-            {
-                return true;
-            }
-            else
-            {
-                mSeenVoxels.insert(
-                    std::pair<std::uint32_t, VoxelId>(
-                        BsoidHash32::hash(id.x, id.y), id));
-                return false;
-            }
+            return !mSeenVoxels.insert(id);
         }
 
         void CrossSection::marchVoxelOnSurface(std::vector<Voxel> const& seeds)
@@ -315,16 +498,15 @@ namespace athena
 
             auto getEdges = [this](Voxel const& v)
             {
-                FieldPoint start, end;
                 int edgeId = 0;
                 std::vector<int> edges;
 
                 for (std::size_t i = 0; i < v.points.size(); ++i)
                 {
-                    start = v.points[i];
-                    end = v.points[(i + 1) % v.points.size()];
-                    float val1 = start.value.w - mMagic;
-                    float val2 = end.value.w - mMagic;
+                    float val1 = mPoints.value(v.points[i]) - mMagic;
+                    float val2 =
+                        mPoints.value(v.points[(i + 1) % v.points.size()]) -
+                        mMagic;
 
                     // All that we care about is the change in sign. If there
                     // is a change, we know the surface crosses this edge.
@@ -371,8 +553,10 @@ namespace athena
                     {
                         auto cPos = (2u * v.id) + glm::u32vec2(1, 1);
                         Point origin = createCellPoint(cPos, mGridDelta / 2.0f);
-                        float originVal = mTree->eval(origin);
-                        auto norm = mTree->grad(origin);
+                        auto sample = mTree->evalWithGradient(origin);
+                        ATHENA_STATS(++mStats.fieldSamples);
+                        float originVal = sample.value;
+                        auto norm = sample.gradient;
                         auto projNorm = norm - glm::proj(norm, glm::normalize(mNormal));
                         projNorm = glm::normalize(projNorm);
                         projNorm = (originVal > mMagic) ? -projNorm : projNorm;
@@ -454,6 +638,7 @@ namespace athena
                 // Now fill its values.
                 Voxel v(top);
                 fillVoxel(v);
+                ATHENA_STATS(++mStats.voxelsMarched);
 
                 // Check how many edges cross the surface.
                 auto edges = getEdges(v);
@@ -494,64 +679,21 @@ namespace athena
             using atlas::math::Point;
             using atlas::math::Normal;
 
-            // We may need to move this to the scope of the segments.
-            std::map<std::uint64_t, LinePoint> computedPoints;
             std::vector<LineSegment> segments;
 
-            auto interpolate = [this](FieldPoint const& p1, FieldPoint const& p2)
+            std::size_t evaluations = 0;
+            auto generatePoint = [this, &evaluations](PointId const& p1,
+                PointId const& p2, FieldPoint const& fp1,
+                FieldPoint const& fp2)
             {
-                using atlas::math::Point2;
-
-                auto pt = glm::mix(p1.value.xyz(), p2.value.xyz(),
-                    (mMagic - p1.value.w) / (p2.value.w - p1.value.w));
-                // Note that for now we assume that this is irrelevant. It may
-                // so happen that there is a case when this is no longer true.
-                auto hash = p1.svHash;
-                auto sv = mSuperVoxels[hash];
-                auto val = sv.eval(pt);
-                auto grad = sv.grad(pt);
-                return FieldPoint(pt, val, grad, hash);
-            };
-
-            auto generatePoint =
-                [&computedPoints, interpolate, this](PointId const& p1,
-                    PointId const& p2, FieldPoint const& fp1,
-                    FieldPoint const& fp2)
-            {
-                auto h1 = BsoidHash32::hash(p1.x, p1.y);
-                auto h2 = BsoidHash32::hash(p2.x, p2.y);
-                
-                // We need to keep in mind that the hashes are order sensitive,
-                // which means that a single edge has two possible hashes: 
-                // (h1, h2) and (h2, h1), so we have to check both.
-                auto edgeHash1 = BsoidHash64::hash(h1, h2);
-                auto edgeHash2 = BsoidHash64::hash(h2, h1);
-
-                // Now look up both hashes.
-                auto entry1 = computedPoints.find(edgeHash1);
-                auto entry2 = computedPoints.find(edgeHash2);
-                
-                if (entry1 != computedPoints.end() || 
-                    entry2 != computedPoints.end())
+                auto edge = edgeId(p1, p2);
+                if (auto entry = mEdgeCache.find(edge, EdgePass::Surface))
                 {
-                    if (entry1 != computedPoints.end())
-                    {
-                        return (*entry1).second;
-                    }
-
-                    return (*entry2).second;
-                }
-                else
-                {
-                    auto pt = interpolate(fp1, fp2);
-                    auto edgeHash = edgeHash1;
-
-                    LinePoint p(pt, edgeHash);
-                    computedPoints.insert(
-                        std::pair<std::uint64_t, LinePoint>(edgeHash1, p));
-                    return p;
+                    return *entry;
                 }
 
+                return mEdgeCache.insert(edge, EdgePass::Surface,
+                    findRoot(fp1, fp2, evaluations));
             };
 
             // Iterate over the set of voxels.
@@ -563,7 +705,8 @@ namespace athena
                 std::uint32_t voxelIndex = 0;
                 for (std::size_t i = 0; i < 4; ++i)
                 {
-                    if (atlas::core::leq(voxel.points[i].value.w, mMagic))
+                    if (atlas::core::leq(mPoints.value(voxel.points[i]),
+                        mMagic))
                     {
                         voxelIndex |= coeffs[i];
                     }
@@ -587,8 +730,8 @@ namespace athena
                     vertList[0] = generatePoint(
                         voxel.id + VoxelDecals[0],
                         voxel.id + VoxelDecals[1],
-                        voxel.points[0],
-                        voxel.points[1]);
+                        mPoints[voxel.points[0]],
+                        mPoints[voxel.points[1]]);
                 }
 
                 if (EdgeTable[voxelIndex] & 2)
@@ -597,8 +740,8 @@ namespace athena
                     vertList[1] = generatePoint(
                         voxel.id + VoxelDecals[1],
                         voxel.id + VoxelDecals[2],
-                        voxel.points[1],
-                        voxel.points[2]);
+                        mPoints[voxel.points[1]],
+                        mPoints[voxel.points[2]]);
                 }
 
 
@@ -608,8 +751,8 @@ namespace athena
                     vertList[2] = generatePoint(
                         voxel.id + VoxelDecals[2],
                         voxel.id + VoxelDecals[3],
-                        voxel.points[2],
-                        voxel.points[3]);
+                        mPoints[voxel.points[2]],
+                        mPoints[voxel.points[3]]);
                 }
 
                 if (EdgeTable[voxelIndex] & 8)
@@ -618,8 +761,8 @@ namespace athena
                     vertList[3] = generatePoint(
                         voxel.id + VoxelDecals[3],
                         voxel.id + VoxelDecals[0],
-                        voxel.points[3],
-                        voxel.points[0]);
+                        mPoints[voxel.points[3]],
+                        mPoints[voxel.points[0]]);
                 }
 
                 for (int i = 0; LineTable[voxelIndex][i] != -1; i += 2)
@@ -631,6 +774,7 @@ namespace athena
                 ++k;
             }
 
+            mRootEvaluations += evaluations;
             return segments;
        }
 
@@ -642,201 +786,289 @@ namespace athena
                return {};
            }
 
-           std::unordered_map<std::uint64_t, FieldPoint> vertices;
-           std::map<std::uint64_t, 
-               std::pair<std::size_t, std::uint64_t>> contourMap;
-           std::vector<std::vector<FieldPoint>> resultContours;
+           std::uint32_t numPoints = 0;
+           for (auto const& segment : segments)
+           {
+               numPoints = std::max(numPoints,
+                   std::max(segment.start.id, segment.end.id) + 1);
+           }
 
-           for (std::size_t i = 0; i < segments.size(); ++i)
+           std::vector<FieldPoint> vertices(numPoints);
+           std::vector<bool> present(numPoints, false);
+           for (auto const& segment : segments)
            {
-               auto start = segments[i].start;
-               auto end = segments[i].end;
+               vertices[segment.start.id] = segment.start.point;
+               vertices[segment.end.id] = segment.end.point;
+               present[segment.start.id] = true;
+               present[segment.end.id] = true;
+           }
 
-               vertices.insert({ start.edge, start.point });
-               vertices.insert({ end.edge, end.point });
+           // Zero-length segments join two points that are really the same
+           // one, so merge them before linking anything.
+           std::vector<std::uint32_t> parent(numPoints);
+           std::iota(parent.begin(), parent.end(), 0);
+           auto find = [&parent](std::uint32_t i)
+           {
+               while (parent[i] != i)
+               {
+                   parent[i] = parent[parent[i]];
+                   i = parent[i];
+               }
+               return i;
+           };
 
-               contourMap.insert({ start.edge, {i, end.edge} });
+           for (auto const& segment : segments)
+           {
+               auto s = find(segment.start.id);
+               auto e = find(segment.end.id);
+               auto dist = glm::distance2(segment.start.point.value,
+                   segment.end.point.value);
+               if (s != e && atlas::core::isZero(dist))
+               {
+                   parent[std::max(s, e)] = std::min(s, e);
+               }
            }
 
-           auto currentPt = contourMap.begin()->first;
-           auto currentIdx = contourMap.begin()->second;
-           std::vector<bool> used(segments.size(), false);
-           auto startPt = currentPt;
-           std::vector<FieldPoint> contour;
-           for (std::size_t i = 0; i < segments.size(); ++i)
+           // Every point has at most one segment leaving it. If the lattice
+           // hands us a second one we keep the first.
+           std::vector<std::uint32_t> next(numPoints, invalidUint());
+           std::vector<bool> hasPrevious(numPoints, false);
+           for (auto const& segment : segments)
            {
-               if (!used[currentIdx.first])
+               auto s = find(segment.start.id);
+               auto e = find(segment.end.id);
+               if (s == e || next[s] != invalidUint())
                {
-                   contour.push_back(vertices[currentPt]);
-                   used[currentIdx.first] = true;
+                   continue;
                }
 
-               // Grab the next entry.
-               auto range = contourMap.equal_range(currentIdx.second);
-               for (auto& it = range.first; it != range.second; ++it)
+               next[s] = e;
+               hasPrevious[e] = true;
+           }
+
+           std::vector<std::vector<FieldPoint>> resultContours;
+           std::vector<bool> visited(numPoints, false);
+           auto walk = [&](std::uint32_t start)
+           {
+               std::vector<FieldPoint> contour;
+               for (auto i = start; i != invalidUint() && !visited[i];
+                   i = next[i])
                {
-                   // Check if the current end point is equal to the point
-                   // we are in. If it is, then we have a degenerate segment.
-                   // Alternatively, we can also check for distance.
-                   auto currentVertex = vertices[currentPt];
-                   auto nextVertex = vertices[it->first];
-                   auto dist = glm::distance2(currentVertex.value, 
-                       nextVertex.value);
-                   if (currentPt == it->first || atlas::core::isZero(dist))
-                   {
-                       used[it->second.first] = true;
-                       continue;
-                   }
+                   visited[i] = true;
+                   contour.push_back(vertices[i]);
+               }
+               resultContours.push_back(std::move(contour));
+           };
 
-                   // Check if there is more than one segment.
-                   if (it->first == startPt && i != (segments.size() - 1))
-                   {
-                       // We have encountered a branch. So first save the 
-                       // current contour and then clear it.
-                       resultContours.push_back(contour);
-                       contour.clear();
-
-                       // Now we need to select the next point. We can do this
-                       // by running through the map until we find the next 
-                       // free vertex.
-                       // HACK: Is there a better way of doing this?
-                       for (auto& vertex : contourMap)
-                       {
-                           if (!used[vertex.second.first])
-                           {
-                               // This vertex hasn't been used yet, so set it
-                               // to be our current vertex.
-                               currentPt = vertex.first;
-                               currentIdx = vertex.second;
-                               startPt = vertex.first;
-                               break;
-                           }
-                       }
-                   }
+           // Open contours (the model leaves the slice) start at the point
+           // nothing leads into. Everything left over is a closed ring.
+           for (std::uint32_t i = 0; i < numPoints; ++i)
+           {
+               if (present[i] && find(i) == i && next[i] != invalidUint() &&
+                   !hasPrevious[i])
+               {
+                   walk(i);
+               }
+           }
 
-                   if (!used[it->second.first])
-                   {
-                       // We haven't used this point yet, then select it to be
-                       // the next one we visit.
-                       currentPt = it->first;
-                       currentIdx = it->second;
-                       break;
-                   }
+           for (std::uint32_t i = 0; i < numPoints; ++i)
+           {
+               if (present[i] && find(i) == i && !visited[i] &&
+                   next[i] != invalidUint())
+               {
+                   walk(i);
                }
            }
 
-           resultContours.push_back(contour);
+           // A slice where every segment collapsed still has a point.
+           if (resultContours.empty())
+           {
+               resultContours.push_back({ vertices[find(segments[0].start.id)] });
+           }
+
            return resultContours;
+       }
+
+       std::vector<FieldPoint> CrossSection::subdivideContour(
+           std::vector<FieldPoint> const& contour, std::size_t size,
+           std::size_t& evaluations) const
+       {
+           using atlas::math::Point;
+
+           std::size_t cSize = contour.size();
 
+           // Prefix sums of the segment lengths, so the segment holding any
+           // arc length can be found with a binary search.
+           std::vector<float> arcLengths(cSize + 1);
+           arcLengths[0] = 0.0f;
+           for (std::size_t i = 0; i < cSize; ++i)
+           {
+               Point start = contour[i].value.xyz();
+               Point end = contour[(i + 1) % cSize].value.xyz();
+               arcLengths[i + 1] = arcLengths[i] + glm::length(end - start);
+           }
+
+           float delta = arcLengths[cSize] / static_cast<float>(size);
+
+           std::vector<FieldPoint> subDivContour;
+           subDivContour.reserve(size);
+           for (std::size_t i = 0; i < size; ++i)
+           {
+               float s = delta * static_cast<float>(i);
+               auto it = std::upper_bound(arcLengths.begin(),
+                   arcLengths.end(), s);
+               std::size_t segment = static_cast<std::size_t>(
+                   std::distance(arcLengths.begin(), it));
+               segment = (segment == 0) ? 0 : segment - 1;
+               segment = std::min(segment, cSize - 1);
+
+               Point A = contour[segment].value.xyz();
+               Point B = contour[(segment + 1) % cSize].value.xyz();
+               float length = arcLengths[segment + 1] - arcLengths[segment];
+               float t = (length > 0.0f) ?
+                   (s - arcLengths[segment]) / length : 0.0f;
+               t = glm::clamp(t, 0.0f, 1.0f);
+
+#if !(ATHENA_DEBUG_CONTOURS)
+               subDivContour.push_back(pushToSurface(glm::mix(A, B, t),
+                   contour[segment], delta, evaluations));
+#elif defined(ATLAS_DEBUG) && (ATHENA_DEBUG_CONTOURS)
+               subDivContour.emplace_back(glm::mix(A, B, t), 0.0f);
+#endif
+           }
+
+           return subDivContour;
        }
 
-       void CrossSection::subdivideContour(int idx, std::size_t size)
+       FieldPoint CrossSection::findRoot(FieldPoint const& p1,
+           FieldPoint const& p2, std::size_t& evaluations) const
        {
            using atlas::math::Point;
            using atlas::math::Vector;
-           using atlas::math::Normal;
-           using atlas::core::areEqual;
 
-           auto& contour = mContours[idx];
+           // Note that for now we assume that the super-voxel of the first
+           // point is good enough for the whole edge.
+           auto hash = p1.svHash;
+           auto const& sv = mSuperVoxels[hash];
 
-#if !(ATHENA_DEBUG_CONTOURS)
-           auto pushToSurface = 
-               [this, contour](Point const& p, std::size_t i, float delta)
+           Point a = p1.value.xyz();
+           Vector d = p2.value.xyz() - a;
+
+           // Keep a bracket [ta, tb] around the crossing so every method
+           // can fall back on it.
+           float ta = 0.0f, tb = 1.0f;
+           float fa = p1.value.w - mMagic;
+           float fb = p2.value.w - mMagic;
+
+           float t = (mRootFinder == RootFinder::Bisection || fa == fb) ?
+               0.5f : fa / (fa - fb);
+           auto sample = sv.evalWithGradient(a + t * d);
+           ++evaluations;
+
+           if (mRootFinder == RootFinder::Linear)
            {
-               // First check if we are already on the surface.
-               SuperVoxel sv = mSuperVoxels[contour[i].svHash];
-               if (areEqual(mMagic, sv.eval(p)))
+               return FieldPoint(a + t * d, sample.value, sample.gradient,
+                   hash);
+           }
+
+           for (std::size_t i = 0; i < mMaxRootIterations; ++i)
+           {
+               float f = sample.value - mMagic;
+               if (std::abs(f) <= mRootTolerance)
                {
-                   float val = sv.eval(p);
-                   Normal g = sv.grad(p);
-                   return FieldPoint(p, val, g);
+                   break;
                }
 
-               Point in = p;
-               float inVal = sv.eval(in);
-               auto norm = sv.grad(in);
-               auto projNorm = norm - glm::proj(norm, glm::normalize(mNormal));
-               projNorm = (inVal > mMagic) ? -projNorm : projNorm;
-               projNorm = glm::normalize(projNorm);
-
-               float d = delta;
-               Point out = in + (delta * projNorm);
-               float outVal = sv.eval(out);
-               while (glm::sign(outVal - mMagic) == glm::sign(inVal - mMagic))
+               if ((f < 0.0f) == (fa < 0.0f))
                {
-                   d += delta;
-                   out = in + (d * projNorm);
-                   outVal = sv.eval(out);
+                   ta = t;
+                   fa = f;
+               }
+               else
+               {
+                   tb = t;
+                   fb = f;
                }
 
-               Point newPt = glm::mix(in, out, (mMagic - inVal) / (outVal - inVal));
-               float val = sv.eval(newPt);
-               Normal g = sv.grad(newPt);
-               return FieldPoint(newPt, val, g);
-           };
-#elif defined(ATLAS_DEBUG) && (ATHENA_DEBUG_CONTOURS)
-           auto pushToSurface = [](Point const& p, std::size_t i, float delta)
-           {
-               return FieldPoint(p, 0.0f);
-           };
-#endif
+               switch (mRootFinder)
+               {
+               case RootFinder::Secant:
+                   t = (fa == fb) ? 0.5f * (ta + tb) :
+                       ta - fa * (tb - ta) / (fb - fa);
+                   break;
 
-           // Compute the arc length using the contour.
-           float delta = 0.0f;
-           {
-               float arcLength = 0.0f;
-               std::size_t cSize = contour.size();
-               for (std::size_t i = 0; i < cSize; ++i)
+               case RootFinder::Newton:
                {
-                   Point start = contour[i + 0].value.xyz();
-                   Point end = contour[(i + 1) % cSize].value.xyz();
+                   // Safeguarded: if the step leaves the bracket, bisect.
+                   float df = glm::dot(sample.gradient, d);
+                   float next = (df == 0.0f) ? ta : t - f / df;
+                   t = (next > ta && next < tb) ? next : 0.5f * (ta + tb);
+                   break;
+               }
 
-                   arcLength += glm::length(end - start);
+               default:
+                   t = 0.5f * (ta + tb);
+                   break;
                }
 
-               delta = arcLength / static_cast<float>(size);
+               sample = sv.evalWithGradient(a + t * d);
+               ++evaluations;
            }
 
-           std::vector<FieldPoint> subDivContour;
-           std::size_t currentSegment = 0;
-           Point previousSegmentPoint = contour[0].value.xyz();
-           subDivContour.push_back(pushToSurface(previousSegmentPoint, 
-               currentSegment, delta));
-           float dist = delta;
-           for (std::size_t i = 1; i < size; ++i)
+           return FieldPoint(a + t * d, sample.value, sample.gradient, hash);
+       }
+
+       FieldPoint CrossSection::pushToSurface(atlas::math::Point const& p,
+           FieldPoint const& origin, float delta,
+           std::size_t& evaluations) const
+       {
+           using atlas::math::Point;
+           using atlas::math::Normal;
+
+           auto hash = origin.svHash;
+           auto const& sv = mSuperVoxels[hash];
+           auto sample = sv.evalWithGradient(p);
+           ++evaluations;
+
+           // Only move within the slice, so drop the gradient along the
+           // slicing axis.
+           auto inPlane = [this](Normal g)
            {
-               // Find where the next point is going to be.
-               bool done = false;
-               while (!done)
+               g[static_cast<int>(mAxis)] = 0.0f;
+               return g;
+           };
+
+           // Newton steps along the gradient, whatever the edge policy is.
+           // Each step is clamped to the sample spacing so a flat spot in
+           // the field can't throw the point across the model.
+           Point pt = p;
+           for (std::size_t i = 0; i < mMaxRootIterations; ++i)
+           {
+               if (std::abs(sample.value - mMagic) <= mRootTolerance)
                {
-                   // Construct the current segment.
-                   Point A = 
-                       contour[(currentSegment + 0) % contour.size()].value.xyz();
-                   Point B =
-                       contour[(currentSegment + 1) % contour.size()].value.xyz();
-                   Vector eps = dist * ((B - A) / glm::length(B - A));
-                   Point newPt = previousSegmentPoint + eps;
-
-                   if (glm::length(newPt - A) > glm::length(B - A)) {
-                       currentSegment++;
-                       float travelledDistance =
-                           glm::distance(B, previousSegmentPoint);
-                       dist -= travelledDistance;
-                       previousSegmentPoint = B;
-                       continue;
-                   }
+                   break;
+               }
 
-                   // The next point is in this segment.
-                   auto s = pushToSurface(newPt, currentSegment, delta);
-                   previousSegmentPoint = newPt;
-                   subDivContour.emplace_back(s);
+               Normal g = inPlane(sample.gradient);
+               float g2 = glm::dot(g, g);
+               if (g2 == 0.0f)
+               {
+                   break;
+               }
 
-                   dist = delta;
-                   done = true;
+               Normal dir = ((mMagic - sample.value) / g2) * g;
+               float len = glm::length(dir);
+               if (len > delta)
+               {
+                   dir *= delta / len;
                }
+
+               pt += dir;
+               sample = sv.evalWithGradient(pt);
+               ++evaluations;
            }
 
-           contour = subDivContour;
+           return FieldPoint(pt, sample.value, sample.gradient, hash);
        }
 
        float CrossSection::shadowField(FieldPoint const& p)
@@ -853,16 +1085,15 @@ namespace athena
 
            auto getEdges = [this](Voxel const& v)
            {
-               FieldPoint start, end;
                int edgeId = 0;
                std::vector<int> edges;
 
                for (std::size_t i = 0; i < v.points.size(); ++i)
                {
-                   start = v.points[i];
-                   end = v.points[(i + 1) % v.points.size()];
-                   float val1 = start.value.w - mMagic;
-                   float val2 = end.value.w - mMagic;
+                   float val1 = mPoints.value(v.points[i]) - mMagic;
+                   float val2 =
+                       mPoints.value(v.points[(i + 1) % v.points.size()]) -
+                       mMagic;
 
                    if (glm::sign(val1) != glm::sign(val2) ||
                        (glm::sign(val1) == 1 && glm::sign(val2) == 1))
@@ -880,8 +1111,9 @@ namespace athena
                std::array<FieldPoint, 4> shadowPoints;
                {
                    int i = 0;
-                   for (auto& pt : v.points)
+                   for (auto idx : v.points)
                    {
+                       auto pt = mPoints[idx];
                        float shadow = shadowField(pt);
                        FieldPoint shadowPoint = { pt.value.xyz(), shadow };
                        shadowPoints[i] = shadowPoint;
@@ -908,24 +1140,18 @@ namespace athena
 
            frontier.push(mVoxels[0].id);
            std::vector<Voxel> shadowVoxels;
-           std::map<std::uint32_t, VoxelId> seenVoxels;
+           VoxelSet seenVoxels;
+           seenVoxels.reset(mGridSize);
 
            while (!frontier.empty())
            {
                auto top = frontier.front();
                frontier.pop();
 
-               if (seenVoxels.find(BsoidHash32::hash(top.x, top.y)) !=
-                   seenVoxels.end())
+               if (!seenVoxels.insert(top))
                {
                    continue;
                }
-               else
-               {
-                   seenVoxels.insert(
-                       std::pair<std::uint32_t, VoxelId>(
-                           BsoidHash32::hash(top.x, top.y), top));
-               }
 
                Voxel v(top);
                fillVoxel(v);
@@ -954,19 +1180,10 @@ namespace athena
 
                if (containsShadow(v))
                {
-                   // Now we need to change the points from regular field values
-                   // to the shadow field.
-                   Voxel shadowVoxel;
-                   int i = 0;
-                   for (auto& pt : v.points)
-                   {
-                       FieldPoint shadowPoint = pt;
-                       shadowPoint.value.w = shadowField(pt);
-                       shadowVoxel.points[i] = shadowPoint;
-                       ++i;
-                   }
-                   
-                   shadowVoxels.push_back(shadowVoxel);
+                   // The voxel shares its points with the surface pass. The
+                   // shadow field is computed from them when the segments
+                   // are generated.
+                   shadowVoxels.push_back(v);
                }
            }
 
@@ -979,7 +1196,6 @@ namespace athena
            using atlas::math::Point;
            using atlas::math::Normal;
 
-           std::map<std::uint64_t, LinePoint> computedPoints;
            std::vector<LineSegment> shadowSegments;
 
            auto interpolate = [this](FieldPoint const& p1, FieldPoint const& p2)
@@ -993,40 +1209,25 @@ namespace athena
                return p;
            };
 
-           auto generatePoint = 
-               [&computedPoints, interpolate, this](PointId const& p1,
-                   PointId const& p2, FieldPoint const& fp1,
-                   FieldPoint const& fp2)
+           auto shadowPoint = [this](std::uint32_t i)
            {
-               auto h1 = BsoidHash32::hash(p1.x, p1.y);
-               auto h2 = BsoidHash32::hash(p2.x, p2.y);
-
-               auto edgeHash1 = BsoidHash64::hash(h1, h2);
-               auto edgeHash2 = BsoidHash64::hash(h2, h1);
-
-               auto entry1 = computedPoints.find(edgeHash1);
-               auto entry2 = computedPoints.find(edgeHash2);
+               auto p = mPoints[i];
+               p.value.w = shadowField(p);
+               return p;
+           };
 
-               if (entry1 != computedPoints.end() ||
-                   entry2 != computedPoints.end())
+           auto generatePoint = [this, &interpolate](PointId const& p1,
+               PointId const& p2, FieldPoint const& fp1,
+               FieldPoint const& fp2)
+           {
+               auto edge = edgeId(p1, p2);
+               if (auto entry = mEdgeCache.find(edge, EdgePass::Shadow))
                {
-                   if (entry1 != computedPoints.end())
-                   {
-                       return (*entry1).second;
-                   }
-
-                   return (*entry2).second;
+                   return *entry;
                }
-               else
-               {
-                   auto pt = interpolate(fp1, fp2);
-                   auto edgeHash = edgeHash1;
 
-                   LinePoint p(pt, edgeHash);
-                   computedPoints.insert(
-                       std::pair<std::uint64_t, LinePoint>(edgeHash1, p));
-                   return p;
-               }
+               return mEdgeCache.insert(edge, EdgePass::Shadow,
+                   interpolate(fp1, fp2));
            };
 
             // Iterate over the set of voxels.
@@ -1034,11 +1235,17 @@ namespace athena
             std::vector<std::uint32_t> coeffs = { 1, 2, 4, 8 };
             for (auto& voxel : shadowVoxels)
             {
+                std::array<FieldPoint, 4> points;
+                for (std::size_t i = 0; i < 4; ++i)
+                {
+                    points[i] = shadowPoint(voxel.points[i]);
+                }
+
                 // First compute the cell index for our voxel.
                 std::uint32_t voxelIndex = 0;
                 for (std::size_t i = 0; i < 4; ++i)
                 {
-                    if (atlas::core::leq(voxel.points[i].value.w, mShadowMagic))
+                    if (atlas::core::leq(points[i].value.w, mShadowMagic))
                     {
                         voxelIndex |= coeffs[i];
                     }
@@ -1062,8 +1269,8 @@ namespace athena
                     vertList[0] = generatePoint(
                         voxel.id + VoxelDecals[0],
                         voxel.id + VoxelDecals[1],
-                        voxel.points[0],
-                        voxel.points[1]);
+                        points[0],
+                        points[1]);
                 }
 
                 if (EdgeTable[voxelIndex] & 2)
@@ -1072,8 +1279,8 @@ namespace athena
                     vertList[1] = generatePoint(
                         voxel.id + VoxelDecals[1],
                         voxel.id + VoxelDecals[2],
-                        voxel.points[1],
-                        voxel.points[2]);
+                        points[1],
+                        points[2]);
                 }
 
 
@@ -1083,8 +1290,8 @@ namespace athena
                     vertList[2] = generatePoint(
                         voxel.id + VoxelDecals[2],
                         voxel.id + VoxelDecals[3],
-                        voxel.points[2],
-                        voxel.points[3]);
+                        points[2],
+                        points[3]);
                 }
 
                 if (EdgeTable[voxelIndex] & 8)
@@ -1093,8 +1300,8 @@ namespace athena
                     vertList[3] = generatePoint(
                         voxel.id + VoxelDecals[3],
                         voxel.id + VoxelDecals[0],
-                        voxel.points[3],
-                        voxel.points[0]);
+                        points[3],
+                        points[0]);
                 }
 
                 for (int i = 0; LineTable[voxelIndex][i] != -1; i += 2)
@@ -0,0 +1,199 @@
+#include "athena/polygonizer/GridCache.hpp"
+#include "athena/polygonizer/Hash.hpp"
+
+namespace athena
+{
+    namespace polygonizer
+    {
+        PointCache::PointCache() :
+            mStride(0),
+            mDense(false),
+            mSize(0)
+        { }
+
+        void PointCache::reset(std::uint32_t gridSize,
+            std::size_t maxDensePoints)
+        {
+            clear();
+
+            // A cross-section with n voxels per side has n + 1 points.
+            mStride = gridSize + 1;
+            std::size_t numPoints =
+                static_cast<std::size_t>(mStride) * mStride;
+            mDense = numPoints <= maxDensePoints;
+
+            if (mDense)
+            {
+                mEntries.resize(numPoints, invalidUint());
+            }
+        }
+
+        void PointCache::clear()
+        {
+            mEntries.clear();
+            mSparseEntries.clear();
+            mSize = 0;
+        }
+
+        std::uint32_t PointCache::find(PointId const& id) const
+        {
+            // Seeds can land outside of the grid before they are walked
+            // back onto the surface, so those always go to the sparse map.
+            if (mDense && id.x < mStride && id.y < mStride)
+            {
+                return mEntries[id.x * mStride + id.y];
+            }
+
+            auto entry = mSparseEntries.find(BsoidHash32::hash(id.x, id.y));
+            return (entry) ? *entry : invalidUint();
+        }
+
+        void PointCache::insert(PointId const& id, std::uint32_t index)
+        {
+            if (mDense && id.x < mStride && id.y < mStride)
+            {
+                auto& entry = mEntries[id.x * mStride + id.y];
+                if (entry == invalidUint())
+                {
+                    entry = index;
+                    ++mSize;
+                }
+                return;
+            }
+
+            if (mSparseEntries.insert(BsoidHash32::hash(id.x, id.y), index))
+            {
+                ++mSize;
+            }
+        }
+
+        std::size_t PointCache::size() const
+        {
+            return mSize;
+        }
+
+        bool PointCache::isDense() const
+        {
+            return mDense;
+        }
+
+        VoxelSet::VoxelSet() :
+            mStride(0),
+            mDense(false),
+            mSize(0)
+        { }
+
+        void VoxelSet::reset(std::uint32_t gridSize,
+            std::size_t maxDensePoints)
+        {
+            clear();
+
+            // Decide on the number of points, like PointCache does, so the
+            // caches of a section are always dense or sparse together.
+            mStride = gridSize;
+            std::size_t numPoints =
+                static_cast<std::size_t>(gridSize + 1) * (gridSize + 1);
+            std::size_t numVoxels =
+                static_cast<std::size_t>(mStride) * mStride;
+            mDense = numPoints <= maxDensePoints;
+
+            if (mDense)
+            {
+                mBits.resize(numVoxels, false);
+            }
+        }
+
+        void VoxelSet::clear()
+        {
+            mBits.clear();
+            mSparseVoxels.clear();
+            mSize = 0;
+        }
+
+        bool VoxelSet::insert(VoxelId const& id)
+        {
+            if (mDense && id.x < mStride && id.y < mStride)
+            {
+                std::size_t i = id.x * mStride + id.y;
+                if (mBits[i])
+                {
+                    return false;
+                }
+
+                mBits[i] = true;
+                ++mSize;
+                return true;
+            }
+
+            if (mSparseVoxels.insert(BsoidHash32::hash(id.x, id.y), 1))
+            {
+                ++mSize;
+                return true;
+            }
+
+            return false;
+        }
+
+        bool VoxelSet::contains(VoxelId const& id) const
+        {
+            if (mDense && id.x < mStride && id.y < mStride)
+            {
+                return mBits[id.x * mStride + id.y];
+            }
+
+            return mSparseVoxels.find(BsoidHash32::hash(id.x, id.y)) !=
+                nullptr;
+        }
+
+        std::size_t VoxelSet::size() const
+        {
+            return mSize;
+        }
+
+        EdgeCache::EdgeCache() :
+            mNumPoints{ 0, 0 }
+        { }
+
+        void EdgeCache::clear()
+        {
+            mPoints.clear();
+            mNumPoints[0] = 0;
+            mNumPoints[1] = 0;
+        }
+
+        LinePoint const* EdgeCache::find(std::uint64_t edge,
+            EdgePass pass) const
+        {
+            return mPoints.find(key(edge, pass));
+        }
+
+        LinePoint EdgeCache::insert(std::uint64_t edge, EdgePass pass,
+            FieldPoint const& point)
+        {
+            auto& count = mNumPoints[static_cast<std::uint32_t>(pass)];
+            LinePoint p(point, edge, count);
+            if (mPoints.insert(key(edge, pass), p))
+            {
+                ++count;
+                return p;
+            }
+
+            return *mPoints.find(key(edge, pass));
+        }
+
+        std::size_t EdgeCache::size() const
+        {
+            return mPoints.size();
+        }
+
+        std::uint32_t EdgeCache::numPoints(EdgePass pass) const
+        {
+            return mNumPoints[static_cast<std::uint32_t>(pass)];
+        }
+
+        std::uint64_t EdgeCache::key(std::uint64_t edge, EdgePass pass)
+        {
+            return (edge << 1) | static_cast<std::uint64_t>(pass);
+        }
+    }
+}
@@ -1,111 +1,113 @@
 #include "athena/polygonizer/Lattice.hpp"
 
-#include <functional>
-#include <unordered_set>
+#if defined(ATHENA_PARALLEL)
+#include <tbb/parallel_for.h>
+#endif
 
 namespace athena
 {
     namespace polygonizer
     {
-        void Lattice::makeLattice(std::vector<std::vector<Voxel>> const& voxels)
+        void Lattice::makeLattice(
+            std::vector<std::vector<Voxel> const*> const& voxels,
+            std::vector<PointPool const*> const& points)
         {
-            using atlas::math::Point;
-
-            struct LatticePoint
-            {
-                LatticePoint(Point const& p) :
-                    point(p)
-                { }
+            clearBuffers();
 
-                LatticePoint(Point const& p, std::uint32_t i) :
-                    point(p),
-                    index(i)
-                { }
+            std::size_t numSlices = voxels.size();
 
-                bool operator==(LatticePoint const& rhs) const
-                {
-                    return point == rhs.point;
-                }
+            // Voxels of a slice already share their corners through the
+            // point pool (which is keyed on the grid point id), so the pool
+            // index is all we need to dedup. The first pass numbers the
+            // vertices of each slice so the buffers can be sized up front.
+            std::vector<std::vector<std::uint32_t>> remaps(numSlices);
+            std::vector<std::uint32_t> numVertices(numSlices, 0);
+            auto countSlice = [&](std::size_t s)
+            {
+                auto const& list = *voxels[s];
+                auto& remap = remaps[s];
+                remap.assign(points[s]->size(), invalidUint());
 
-                bool operator!=(LatticePoint const& rhs) const
+                std::uint32_t count = 0;
+                for (auto& cell : list)
                 {
-                    return !(*this == rhs);
+                    for (auto idx : cell.points)
+                    {
+                        if (remap[idx] == invalidUint())
+                        {
+                            remap[idx] = count++;
+                        }
+                    }
                 }
-
-                Point point;
-                std::uint32_t index;
+                numVertices[s] = count;
             };
 
-            struct LatticeHash
+            std::vector<std::uint32_t> vertexStart(numSlices, 0);
+            std::vector<std::uint32_t> indexStart(numSlices, 0);
+            auto prefixSums = [&]()
             {
-                std::size_t operator()(LatticePoint const& p) const
+                std::uint32_t v = 0, i = 0;
+                for (std::size_t s = 0; s < numSlices; ++s)
                 {
-                    return std::hash<float>()(p.point.x + p.point.y + 
-                        p.point.z);
+                    auto numIndices =
+                        static_cast<std::uint32_t>(8 * voxels[s]->size());
+                    vertexStart[s] = v;
+                    indexStart[s] = i;
+                    offsets.emplace_back((numIndices == 0) ? 0 : i,
+                        numIndices);
+                    v += numVertices[s];
+                    i += numIndices;
                 }
-            };
 
-            clearBuffers();
+                vertices.resize(v);
+                indices.resize(i);
+            };
 
-            for (auto& list : voxels)
+            auto fillSlice = [&](std::size_t s)
             {
-                if (list.empty())
-                {
-                    offsets.emplace_back(0, 0);
-                    continue;
-                }
+                auto const& list = *voxels[s];
+                auto const& pool = *points[s];
+                auto const& remap = remaps[s];
 
-                std::vector<Point> verts;
-                std::vector<std::uint32_t> idxs;
-                std::uint32_t idxStart = 0;
-                for (auto& cell : list)
+                for (std::size_t idx = 0; idx < remap.size(); ++idx)
                 {
-                    for (auto& pt : cell.points)
+                    if (remap[idx] != invalidUint())
                     {
-                        verts.push_back(pt.value.xyz());
+                        vertices[vertexStart[s] + remap[idx]] = pool.position(
+                            static_cast<std::uint32_t>(idx));
                     }
-
-                    idxs.push_back(idxStart);
-                    idxs.push_back(idxStart + 1);
-
-                    idxs.push_back(idxStart + 1);
-                    idxs.push_back(idxStart + 2);
-
-                    idxs.push_back(idxStart + 2);
-                    idxs.push_back(idxStart + 3);
-
-                    idxs.push_back(idxStart + 3);
-                    idxs.push_back(idxStart);
-                    
-                    idxStart = static_cast<std::uint32_t>(verts.size());
                 }
-                
-                std::unordered_set<LatticePoint, LatticeHash> uniqueVertices;
-                std::uint32_t current = vertices.size();
-                std::uint32_t start = indices.size();
-                std::uint32_t size = 0;
-                for (auto& idx : idxs)
-                {
-                    auto pt = verts[idx];
-                    if (uniqueVertices.find(pt) == uniqueVertices.end())
-                    {
-                        indices.push_back(current);
-                        vertices.push_back(pt);
 
-                        uniqueVertices.emplace(pt, current);
-                        size++;
-                        current++;
-                    }
-                    else
+                // Each voxel contributes its four edges.
+                auto out = indices.begin() + indexStart[s];
+                for (auto& cell : list)
+                {
+                    for (std::size_t i = 0; i < 4; ++i)
                     {
-                        auto uniqueV = *uniqueVertices.find(pt);
-                        indices.push_back(uniqueV.index);
-                        size++;
+                        *out++ = vertexStart[s] + remap[cell.points[i]];
+                        *out++ = vertexStart[s] +
+                            remap[cell.points[(i + 1) % 4]];
                     }
                 }
+            };
 
-                offsets.emplace_back(start, size);
+#if defined(ATHENA_PARALLEL)
+            tbb::parallel_for(static_cast<std::size_t>(0), numSlices,
+                countSlice);
+            prefixSums();
+            tbb::parallel_for(static_cast<std::size_t>(0), numSlices,
+                fillSlice);
+#else
+            for (std::size_t s = 0; s < numSlices; ++s)
+            {
+                countSlice(s);
+            }
+            prefixSums();
+            for (std::size_t s = 0; s < numSlices; ++s)
+            {
+                fillSlice(s);
             }
+#endif
         }
 
         void Lattice::clearBuffers()
@@ -115,4 +117,4 @@ namespace athena
             offsets.clear();
         }
     }
-}
\ No newline at end of file
+}
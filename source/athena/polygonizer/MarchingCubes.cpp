@@ -1,9 +1,15 @@
 #include "athena/polygonizer/MarchingCubes.hpp"
+#include "athena/polygonizer/GridCache.hpp"
 
 #include <atlas/core/Timer.hpp>
 
 #include <cinttypes>
-#include <numeric>
+#include <limits>
+#include <queue>
+
+#if defined(ATHENA_PARALLEL)
+#include <tbb/parallel_for.h>
+#endif
 
 
 namespace athena
@@ -25,6 +31,40 @@ namespace athena
             { 0, 1, 1 }
         };
 
+        // For each of the twelve cell edges, the corner that the edge
+        // starts from and the axis that it runs along.
+        constexpr std::uint32_t EdgeOrigins[12][2] =
+        {
+            { 0, 0 }, { 1, 1 }, { 3, 0 }, { 0, 1 },
+            { 4, 0 }, { 5, 1 }, { 7, 0 }, { 4, 1 },
+            { 0, 2 }, { 1, 2 }, { 2, 2 }, { 3, 2 }
+        };
+
+        // The corner at the other end of each edge.
+        constexpr std::uint32_t EdgeEnds[12] =
+        {
+            1, 2, 2, 3, 5, 6, 6, 7, 4, 5, 6, 7
+        };
+
+        // The corners that make up each face of a cell, along with the
+        // direction of the neighbouring cell across that face.
+        constexpr std::uint32_t FaceCorners[6][4] =
+        {
+            { 0, 3, 4, 7 }, { 1, 2, 5, 6 },
+            { 0, 1, 4, 5 }, { 2, 3, 6, 7 },
+            { 0, 1, 2, 3 }, { 4, 5, 6, 7 }
+        };
+
+        constexpr int FaceNeighbours[6][3] =
+        {
+            { -1, 0, 0 }, { 1, 0, 0 },
+            { 0, -1, 0 }, { 0, 1, 0 },
+            { 0, 0, -1 }, { 0, 0, 1 }
+        };
+
+        constexpr std::uint32_t invalidVertex =
+            std::numeric_limits<std::uint32_t>::max();
+
         constexpr std::uint32_t EdgeTable[256] =
         {
             0x0  , 0x109, 0x203, 0x30a, 0x406, 0x50f, 0x605, 0x70c,
@@ -323,29 +363,49 @@ namespace athena
 
 
         MarchingCubes::MarchingCubes() :
+            mSparse(false),
+            mFieldEvaluations(0),
             mName("model")
         { }
 
+        MarchingCubes::MarchingCubes(tree::TreePointer const& model,
+            std::string const& name, float isoValue) :
+            mSparse(false),
+            mTree(model),
+            mMagic(isoValue),
+            mFieldEvaluations(0),
+            mName(name)
+        { }
+
         MarchingCubes::MarchingCubes(tree::BlobTree const& model,
             std::string const& name, float isoValue) :
-            mTree(std::make_unique<tree::BlobTree>(model)),
-            mName(name),
-            mMagic(isoValue)
+            mSparse(false),
+            mTree(std::make_shared<tree::BlobTree const>(model)),
+            mMagic(isoValue),
+            mFieldEvaluations(0),
+            mName(name)
         { }
 
         MarchingCubes::MarchingCubes(MarchingCubes&& mc) :
             mResolution(mc.mResolution),
-            mMesh(std::move(mMesh)),
-            mGrid(mc.mGrid),
+            mSparse(mc.mSparse),
+            mMesh(std::move(mc.mMesh)),
+            mGrid(std::move(mc.mGrid)),
             mTree(std::move(mc.mTree)),
             mMagic(mc.mMagic),
+            mFieldEvaluations(mc.mFieldEvaluations),
             mLog(std::move(mc.mLog)),
             mName(mc.mName)
         { }
 
+        void MarchingCubes::setModel(tree::TreePointer const& model)
+        {
+            mTree = model;
+        }
+
         void MarchingCubes::setModel(tree::BlobTree const& model)
         {
-            mTree = std::make_unique<tree::BlobTree>(model);
+            mTree = std::make_shared<tree::BlobTree const>(model);
         }
 
         void MarchingCubes::setIsoValue(float isoValue)
@@ -358,34 +418,72 @@ namespace athena
             mResolution = res;
         }
 
-        void MarchingCubes::polygonize()
+        void MarchingCubes::setSparse(bool sparse)
+        {
+            mSparse = sparse;
+        }
+
+        PolygonizerStats MarchingCubes::polygonize()
         {
             using atlas::utils::Mesh;
             using atlas::core::Timer;
 
+            PolygonizerStats stats;
             Timer<float> global;
 
             global.start();
+            setUpGrid();
+            mMesh = Mesh();
 
+            if (mSparse)
             {
                 Timer<float> section;
                 section.start();
-                constructGrid();
+                polygonizeSparse();
+                stats.stages.push_back({ "sparse", section.elapsed() });
             }
-
+            else
             {
-                Timer<float> section;
-                section.start();
-                createTriangles();
+                {
+                    Timer<float> section;
+                    section.start();
+                    constructGrid();
+                    stats.stages.push_back({ "grid", section.elapsed() });
+                }
+
+                std::vector<std::uint32_t> edgeVertices;
+                {
+                    Timer<float> section;
+                    section.start();
+                    edgeVertices = createVertices();
+                    stats.stages.push_back({ "vertices", section.elapsed() });
+                }
+
+                // One sample per grid point, plus the gradient of every
+                // vertex.
+                mFieldEvaluations = mGrid.size() + mMesh.vertices().size();
+
+                {
+                    Timer<float> section;
+                    section.start();
+                    createTriangles(edgeVertices);
+                    stats.stages.push_back({ "cells", section.elapsed() });
+                    stats.cells = static_cast<std::size_t>(
+                        mResolution.x - 1) * (mResolution.y - 1) *
+                        (mResolution.z - 1);
+                }
             }
 
-            Mesh::fromTriangleSoup(mVertices, mIndices, mMesh, mNormals);
+            stats.total = global.elapsed();
+            stats.vertices = mMesh.vertices().size();
+            stats.fieldEvaluations = mFieldEvaluations;
 
             mLog << "\nSummary: ";
             mLog << mName + "\n";
             mLog << "#===========================#\n";
-            mLog << "Total runtime: " << global.elapsed() << " seconds\n";
-            mLog << "Total vertices generated: " << mMesh.vertices().size() << "\n";
+            mLog << "Total runtime: " << stats.total << " seconds\n";
+            mLog << "Total vertices generated: " << stats.vertices << "\n";
+            return stats;
         }
 
         atlas::utils::Mesh& MarchingCubes::getMesh()
@@ -418,237 +516,536 @@ namespace athena
             mMesh.saveToFile(mName + "_mc.obj");
         }
 
-        void MarchingCubes::constructGrid()
+        void MarchingCubes::setUpGrid()
         {
-            using atlas::math::Point;
-
             auto modelBox = mTree->getTreeBox();
             auto start = modelBox.pMin;
             auto end = modelBox.pMax;
 
-            // Initialize the grid to the set resolution.
-            mGrid.resize(mResolution.x,
-                std::vector<std::vector<VoxelPoint>>(mResolution.y,
-                    std::vector<VoxelPoint>(mResolution.z)));
-
             // Compute the seize of each voxel.
-            glm::vec3 delta = (glm::abs(start - end));
-            delta.x /= mResolution.x - 1;
-            delta.y /= mResolution.y - 1;
-            delta.z /= mResolution.z - 1;
+            mStart = start;
+            mDelta = (glm::abs(start - end));
+            mDelta.x /= mResolution.x - 1;
+            mDelta.y /= mResolution.y - 1;
+            mDelta.z /= mResolution.z - 1;
+        }
 
-            for (std::size_t x = 0; x < mResolution.x; ++x)
+        void MarchingCubes::constructGrid()
+        {
+            // Initialize the grid to the set resolution.
+            mGrid.clear();
+            mGrid.resize(static_cast<std::size_t>(mResolution.x) *
+                mResolution.y * mResolution.z);
+
+            // Each slab of constant x is filled independently, evaluating
+            // the field one row of z at a time so the tree can use the
+            // batched kernels.
+            auto fillSlab = [this](std::size_t x)
             {
+                fields::PointBatch row(mResolution.z);
+                std::vector<float> values;
                 for (std::size_t y = 0; y < mResolution.y; ++y)
                 {
                     for (std::size_t z = 0; z < mResolution.z; ++z)
                     {
-                        Point pt =
-                        {
-                            start.x + x * delta.x,
-                            start.y + y * delta.y,
-                            start.z + z * delta.z
-                        };
+                        row.set(z, gridPoint(x, y, z));
+                    }
 
-                        mGrid[x][y][z].data.w = mTree->eval(pt);
-                        mGrid[x][y][z].data.xyz = pt;
+                    mTree->evalBatch(row, values);
+
+                    auto* gridRow = &mGrid[gridIndex(x, y, 0)];
+                    for (std::size_t z = 0; z < mResolution.z; ++z)
+                    {
+                        gridRow[z].data =
+                            atlas::math::Vector4(row[z], values[z]);
                     }
                 }
+            };
+
+#if defined(ATHENA_PARALLEL)
+            tbb::parallel_for(std::size_t(0), std::size_t(mResolution.x),
+                fillSlab);
+#else
+            for (std::size_t x = 0; x < mResolution.x; ++x)
+            {
+                fillSlab(x);
             }
+#endif
         }
         
-        void MarchingCubes::createTriangles()
+        std::vector<std::uint32_t> MarchingCubes::createVertices()
         {
             using atlas::math::Point;
+            using atlas::math::Normal;
 
-            auto interpolateVertices = [this](Point const& p1, Point const& p2, 
-                float val1, float val2)
-            {
-                return glm::mix(p1, p2, (mMagic - val1) / (val2 - val1));
-            };
+            std::size_t numPoints = mGrid.size();
+            std::vector<std::uint32_t> edgeVertices(numPoints * 3,
+                invalidVertex);
 
-            struct Voxel
+            std::size_t axisStrides[3] =
             {
-                Voxel() :
-                    vertices(8)
-                { }
-
-                std::vector<VoxelPoint> vertices;
+                gridIndex(1, 0, 0), gridIndex(0, 1, 0), gridIndex(0, 0, 1)
             };
 
-            for (std::size_t x = 0; x < mResolution.x; ++x)
+            // Calls fn(edge, from, to) for every edge leaving the points in
+            // the given slab that crosses the surface, always in the same
+            // order.
+            auto forEachCrossing = [this, &axisStrides](std::size_t x,
+                auto const& fn)
             {
+                std::size_t bounds[3] =
+                {
+                    mResolution.x, mResolution.y, mResolution.z
+                };
+
                 for (std::size_t y = 0; y < mResolution.y; ++y)
                 {
                     for (std::size_t z = 0; z < mResolution.z; ++z)
                     {
-                        Voxel v;
-                        for (std::size_t i = 0; i < 8; ++i)
+                        std::size_t coords[3] = { x, y, z };
+                        std::size_t from = gridIndex(x, y, z);
+                        bool inside = mGrid[from].data.w < mMagic;
+                        for (std::size_t axis = 0; axis < 3; ++axis)
                         {
-                            std::size_t newX = x + VoxelDecals[i][0];
-                            std::size_t newY = y + VoxelDecals[i][1];
-                            std::size_t newZ = z + VoxelDecals[i][2];
-
-                            newX = (newX < mResolution.x) ?
-                                newX : mResolution.x - 1;
-                            newY = (newY < mResolution.y) ?
-                                newY : mResolution.y - 1;
-                            newZ = (newZ < mResolution.z) ?
-                                newZ : mResolution.z - 1;
-                            v.vertices[i] = mGrid[newX][newY][newZ];
+                            if (coords[axis] + 1 >= bounds[axis])
+                            {
+                                continue;
+                            }
+
+                            std::size_t to = from + axisStrides[axis];
+                            if (inside != (mGrid[to].data.w < mMagic))
+                            {
+                                fn(edgeIndex(from, axis), from, to);
+                            }
                         }
+                    }
+                }
+            };
+
+            // First count the crossings in each slab, so that every slab
+            // knows where its vertices start.
+            std::vector<std::uint32_t> slabOffsets(mResolution.x + 1, 0);
+            auto countSlab = [&slabOffsets, &forEachCrossing](std::size_t x)
+            {
+                std::uint32_t count = 0;
+                forEachCrossing(x, [&count](std::size_t, std::size_t,
+                    std::size_t)
+                {
+                    ++count;
+                });
+                slabOffsets[x + 1] = count;
+            };
+
+#if defined(ATHENA_PARALLEL)
+            tbb::parallel_for(std::size_t(0), std::size_t(mResolution.x),
+                countSlab);
+#else
+            for (std::size_t x = 0; x < mResolution.x; ++x)
+            {
+                countSlab(x);
+            }
+#endif
+
+            for (std::size_t x = 0; x < mResolution.x; ++x)
+            {
+                slabOffsets[x + 1] += slabOffsets[x];
+            }
+
+            // Now compute each vertex (and its normal) exactly once.
+            auto& vertices = mMesh.vertices();
+            auto& normals = mMesh.normals();
+            vertices.resize(slabOffsets.back());
+            normals.resize(slabOffsets.back());
+
+            auto fillSlab = [this, &slabOffsets, &forEachCrossing, &vertices,
+                &normals, &edgeVertices](std::size_t x)
+            {
+                std::uint32_t next = slabOffsets[x];
+                forEachCrossing(x, [this, &next, &vertices, &normals,
+                    &edgeVertices](std::size_t edge, std::size_t from,
+                    std::size_t to)
+                {
+                    auto const& a = mGrid[from].data;
+                    auto const& b = mGrid[to].data;
+                    Point vert = glm::mix(a.xyz(), b.xyz(),
+                        (mMagic - a.w) / (b.w - a.w));
+
+                    vertices[next] = vert;
+                    normals[next] = -mTree->grad(vert);
+                    edgeVertices[edge] = next++;
+                });
+            };
+
+#if defined(ATHENA_PARALLEL)
+            tbb::parallel_for(std::size_t(0), std::size_t(mResolution.x),
+                fillSlab);
+#else
+            for (std::size_t x = 0; x < mResolution.x; ++x)
+            {
+                fillSlab(x);
+            }
+#endif
+
+            mLog << "Vertices generated: " << vertices.size() <<
+                " (one gradient evaluation each)\n";
+            return edgeVertices;
+        }
+
+        void MarchingCubes::createTriangles(
+            std::vector<std::uint32_t> const& edgeVertices)
+        {
+            using atlas::core::Timer;
+
+            // We need at least two samples along each axis to have a cell.
+            if (mResolution.x < 2 || mResolution.y < 2 || mResolution.z < 2)
+            {
+                return;
+            }
+
+            // Offsets from the first corner of a cell to each of its eight
+            // corners in the flat grid.
+            std::size_t cornerOffsets[8];
+            for (std::size_t i = 0; i < 8; ++i)
+            {
+                cornerOffsets[i] = gridIndex(VoxelDecals[i][0],
+                    VoxelDecals[i][1], VoxelDecals[i][2]);
+            }
+
+            // Each slab of cells writes to its own index buffer, which are
+            // then joined in order so the output doesn't depend on
+            // scheduling.
+            std::size_t numSlabs = mResolution.x - 1;
+            std::vector<std::vector<std::uint32_t>> slabs(numSlabs);
+
+            auto polygonizeSlab = [this, &cornerOffsets, &slabs,
+                &edgeVertices](std::size_t x)
+            {
+                auto& out = slabs[x];
+                std::uint32_t vertList[12];
+
+                for (std::size_t y = 0; y < mResolution.y - 1; ++y)
+                {
+                    for (std::size_t z = 0; z < mResolution.z - 1; ++z)
+                    {
+                        std::size_t cell = gridIndex(x, y, z);
 
                         std::uint32_t voxelIndex = 0;
-                        std::vector<std::uint32_t> coeffs =
-                        { 1, 2, 4, 8, 16, 32, 64, 128 };
                         for (std::size_t i = 0; i < 8; ++i)
                         {
-                            voxelIndex |=
-                                (v.vertices[i].data.w < mMagic) ?
-                                coeffs[i] : 0;
+                            float value = mGrid[cell + cornerOffsets[i]].data.w;
+                            voxelIndex |= (value < mMagic) ? (1u << i) : 0;
                         }
 
-                        if (EdgeTable[voxelIndex] == 0)
+                        auto edges = EdgeTable[voxelIndex];
+                        if (edges == 0)
                         {
                             continue;
                         }
 
-                        std::vector<Point> vertList(12);
-                        if (EdgeTable[voxelIndex] & 1)
+                        for (std::size_t e = 0; e < 12; ++e)
                         {
-                            vertList[0] = interpolateVertices(
-                                v.vertices[0].data.xyz(),
-                                v.vertices[1].data.xyz(),
-                                v.vertices[0].data.w,
-                                v.vertices[1].data.w);
+                            if (edges & (1u << e))
+                            {
+                                auto corner = EdgeOrigins[e][0];
+                                auto axis = EdgeOrigins[e][1];
+                                vertList[e] = edgeVertices[edgeIndex(
+                                    cell + cornerOffsets[corner], axis)];
+                            }
                         }
 
-                        if (EdgeTable[voxelIndex] & 2)
+                        auto const* triangles = TriangleTable[voxelIndex];
+                        for (int i = 0; triangles[i] != -1; ++i)
                         {
-                            vertList[1] = interpolateVertices(
-                                v.vertices[1].data.xyz(),
-                                v.vertices[2].data.xyz(),
-                                v.vertices[1].data.w,
-                                v.vertices[2].data.w);
+                            out.push_back(vertList[triangles[i]]);
                         }
+                    }
+                }
+            };
 
-                        if (EdgeTable[voxelIndex] & 4)
-                        {
-                            vertList[2] = interpolateVertices(
-                                v.vertices[2].data.xyz(),
-                                v.vertices[3].data.xyz(),
-                                v.vertices[2].data.w,
-                                v.vertices[3].data.w);
-                        }
+            Timer<float> timer;
+            timer.start();
 
-                        if (EdgeTable[voxelIndex] & 8)
-                        {
-                            vertList[3] = interpolateVertices(
-                                v.vertices[3].data.xyz(),
-                                v.vertices[0].data.xyz(),
-                                v.vertices[3].data.w,
-                                v.vertices[0].data.w);
-                        }
+#if defined(ATHENA_PARALLEL)
+            tbb::parallel_for(std::size_t(0), numSlabs, polygonizeSlab);
+#else
+            for (std::size_t x = 0; x < numSlabs; ++x)
+            {
+                polygonizeSlab(x);
+            }
+#endif
 
-                        if (EdgeTable[voxelIndex] & 16)
-                        {
-                            vertList[4] = interpolateVertices(
-                                v.vertices[4].data.xyz(),
-                                v.vertices[5].data.xyz(),
-                                v.vertices[4].data.w,
-                                v.vertices[5].data.w);
-                        }
+            float elapsed = timer.elapsed();
+            std::size_t numCells = numSlabs * (mResolution.y - 1) *
+                (mResolution.z - 1);
+            mLog << "Cells processed: " << numCells << " in " << elapsed <<
+                " seconds";
+            if (elapsed > 0.0f)
+            {
+                mLog << " (" << numCells / elapsed << " cells/second)";
+            }
+            mLog << "\n";
 
-                        if (EdgeTable[voxelIndex] & 32)
-                        {
-                            vertList[5] = interpolateVertices(
-                                v.vertices[5].data.xyz(),
-                                v.vertices[6].data.xyz(),
-                                v.vertices[5].data.w,
-                                v.vertices[6].data.w);
-                        }
+            std::size_t numIndices = 0;
+            for (auto const& slab : slabs)
+            {
+                numIndices += slab.size();
+            }
 
-                        if (EdgeTable[voxelIndex] & 64)
-                        {
-                            vertList[6] = interpolateVertices(
-                                v.vertices[6].data.xyz(),
-                                v.vertices[7].data.xyz(),
-                                v.vertices[6].data.w,
-                                v.vertices[7].data.w);
-                        }
+            auto& indices = mMesh.indices();
+            indices.reserve(numIndices);
+            for (auto const& slab : slabs)
+            {
+                indices.insert(indices.end(), slab.begin(), slab.end());
+            }
+        }
 
-                        if (EdgeTable[voxelIndex] & 128)
-                        {
-                            vertList[7] = interpolateVertices(
-                                v.vertices[7].data.xyz(),
-                                v.vertices[4].data.xyz(),
-                                v.vertices[7].data.w,
-                                v.vertices[4].data.w);
-                        }
+        void MarchingCubes::polygonizeSparse()
+        {
+            using atlas::math::Point;
+            using atlas::math::Normal;
+            using atlas::core::Timer;
 
-                        if (EdgeTable[voxelIndex] & 256)
-                        {
-                            vertList[8] = interpolateVertices(
-                                v.vertices[0].data.xyz(),
-                                v.vertices[4].data.xyz(),
-                                v.vertices[0].data.w,
-                                v.vertices[4].data.w);
-                        }
+            if (mResolution.x < 2 || mResolution.y < 2 || mResolution.z < 2)
+            {
+                return;
+            }
 
-                        if (EdgeTable[voxelIndex] & 512)
-                        {
-                            vertList[9] = interpolateVertices(
-                                v.vertices[1].data.xyz(),
-                                v.vertices[5].data.xyz(),
-                                v.vertices[1].data.w,
-                                v.vertices[5].data.w);
-                        }
+            Timer<float> timer;
+            timer.start();
 
-                        if (EdgeTable[voxelIndex] & 1024)
-                        {
-                            vertList[10] = interpolateVertices(
-                                v.vertices[2].data.xyz(),
-                                v.vertices[6].data.xyz(),
-                                v.vertices[2].data.w,
-                                v.vertices[6].data.w);
-                        }
+            glm::u32vec3 numCells = mResolution - glm::u32vec3(1);
 
-                        if (EdgeTable[voxelIndex] & 2048)
-                        {
-                            vertList[11] = interpolateVertices(
-                                v.vertices[3].data.xyz(),
-                                v.vertices[7].data.xyz(),
-                                v.vertices[3].data.w,
-                                v.vertices[7].data.w);
-                        }
+            // Field values are only computed for the corners of the cells
+            // that we visit, and each crossing is only turned into a vertex
+            // once.
+            FlatHashMap<std::uint64_t, float> values;
+            FlatHashMap<std::uint64_t, std::uint32_t> edgeVertices;
+            FlatHashMap<std::uint64_t, std::uint8_t> visited;
+
+            auto cornerValue = [this, &values](std::size_t x, std::size_t y,
+                std::size_t z)
+            {
+                std::uint64_t point = gridIndex(x, y, z);
+                auto value = values.find(point);
+                if (value)
+                {
+                    return *value;
+                }
+
+                float val = mTree->eval(gridPoint(x, y, z));
+                values.insert(point, val);
+                return val;
+            };
+
+            auto cellIndex = [this, &cornerValue](glm::u32vec3 const& cell,
+                float* corners)
+            {
+                std::uint32_t voxelIndex = 0;
+                for (std::size_t i = 0; i < 8; ++i)
+                {
+                    corners[i] = cornerValue(cell.x + VoxelDecals[i][0],
+                        cell.y + VoxelDecals[i][1], cell.z + VoxelDecals[i][2]);
+                    voxelIndex |= (corners[i] < mMagic) ? (1u << i) : 0;
+                }
+
+                return voxelIndex;
+            };
+
+            auto& vertices = mMesh.vertices();
+            auto& normals = mMesh.normals();
+            auto& indices = mMesh.indices();
+
+            auto edgeVertex = [this, &edgeVertices, &vertices, &normals](
+                glm::u32vec3 const& origin, std::size_t axis, float from,
+                float to)
+            {
+                std::uint64_t edge = edgeIndex(
+                    gridIndex(origin.x, origin.y, origin.z), axis);
+                auto vertex = edgeVertices.find(edge);
+                if (vertex)
+                {
+                    return *vertex;
+                }
+
+                glm::u32vec3 end = origin;
+                end[static_cast<int>(axis)] += 1;
+                Point a = gridPoint(origin.x, origin.y, origin.z);
+                Point b = gridPoint(end.x, end.y, end.z);
+                Point vert = glm::mix(a, b, (mMagic - from) / (to - from));
+
+                auto idx = static_cast<std::uint32_t>(vertices.size());
+                vertices.push_back(vert);
+                normals.push_back(-mTree->grad(vert));
+                edgeVertices.insert(edge, idx);
+                return idx;
+            };
+
+            // Follow the gradient from a seed until we reach a cell that the
+            // surface passes through.
+            std::size_t walkEvaluations = 0;
+            auto walkToSurface = [this, &numCells, &cellIndex,
+                &walkEvaluations](glm::u32vec3& cell)
+            {
+                float corners[8];
+                std::uint32_t maxSteps = numCells.x + numCells.y + numCells.z;
+                for (std::uint32_t step = 0; step < maxSteps; ++step)
+                {
+                    if (EdgeTable[cellIndex(cell, corners)] != 0)
+                    {
+                        return true;
+                    }
+
+                    Point centre = gridPoint(cell.x, cell.y, cell.z) +
+                        0.5f * mDelta;
+                    auto sample = mTree->evalWithGradient(centre);
+                    ++walkEvaluations;
+                    Normal dir = (sample.value > mMagic) ?
+                        -sample.gradient : sample.gradient;
+
+                    auto absDir = glm::abs(dir);
+                    int axis = (absDir.x > absDir.y) ?
+                        ((absDir.x > absDir.z) ? 0 : 2) :
+                        ((absDir.y > absDir.z) ? 1 : 2);
+                    if (dir[axis] > 0.0f && cell[axis] + 1 < numCells[axis])
+                    {
+                        cell[axis] += 1;
+                    }
+                    else if (dir[axis] < 0.0f && cell[axis] > 0)
+                    {
+                        cell[axis] -= 1;
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                }
+
+                return false;
+            };
+
+            // Grab seeds from the planes of the grid. Since getSeeds uses
+            // the direction of the vector as the plane normal, we skip the
+            // plane that goes through the origin.
+            std::queue<glm::u32vec3> frontier;
+            for (std::uint32_t y = 0; y < mResolution.y; ++y)
+            {
+                Normal u(0.0f);
+                u.y = mStart.y + y * mDelta.y;
+                if (u.y == 0.0f)
+                {
+                    continue;
+                }
+
+                for (auto const& seed : mTree->getSeeds(u))
+                {
+                    auto v = (seed - mStart) / mDelta;
+                    glm::u32vec3 cell;
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        float c = glm::clamp(v[i], 0.0f,
+                            static_cast<float>(numCells[i] - 1));
+                        cell[i] = static_cast<std::uint32_t>(c);
+                    }
 
-                        for (int i = 0; TriangleTable[voxelIndex][i] != -1;
-                            i += 3)
+                    if (!walkToSurface(cell))
+                    {
+                        continue;
+                    }
+
+                    std::uint64_t id = gridIndex(cell.x, cell.y, cell.z);
+                    if (visited.insert(id, 1))
+                    {
+                        frontier.push(cell);
+                    }
+                }
+            }
+
+            // Now flood through the cells that the surface passes through.
+            std::size_t numVisited = 0;
+            while (!frontier.empty())
+            {
+                auto cell = frontier.front();
+                frontier.pop();
+                ++numVisited;
+
+                float corners[8];
+                auto voxelIndex = cellIndex(cell, corners);
+                auto edges = EdgeTable[voxelIndex];
+                if (edges == 0)
+                {
+                    continue;
+                }
+
+                std::uint32_t vertList[12];
+                for (std::size_t e = 0; e < 12; ++e)
+                {
+                    if (edges & (1u << e))
+                    {
+                        auto corner = EdgeOrigins[e][0];
+                        auto axis = EdgeOrigins[e][1];
+                        auto end = EdgeEnds[e];
+                        glm::u32vec3 origin =
                         {
-                            auto vert = 
-                                vertList[TriangleTable[voxelIndex][i + 0]];
-                            auto normal = mTree->grad(vert);
-                            mVertices.push_back(vert);
-                            mNormals.push_back(-normal);
-
-                            vert = 
-                                vertList[TriangleTable[voxelIndex][i + 1]];
-                            normal = mTree->grad(vert);
-                            mVertices.push_back(vert);
-                            mNormals.push_back(-normal);
-
-                            vert = 
-                                vertList[TriangleTable[voxelIndex][i + 2]];
-                            normal = mTree->grad(vert);
-                            mVertices.push_back(vert);
-                            mNormals.push_back(-normal);
-                        }
+                            cell.x + VoxelDecals[corner][0],
+                            cell.y + VoxelDecals[corner][1],
+                            cell.z + VoxelDecals[corner][2]
+                        };
+                        vertList[e] = edgeVertex(origin, axis,
+                            corners[corner], corners[end]);
+                    }
+                }
+
+                auto const* triangles = TriangleTable[voxelIndex];
+                for (int i = 0; triangles[i] != -1; ++i)
+                {
+                    indices.push_back(vertList[triangles[i]]);
+                }
+
+                // Only move into the neighbours that share a face that the
+                // surface crosses.
+                for (std::size_t f = 0; f < 6; ++f)
+                {
+                    bool inside = corners[FaceCorners[f][0]] < mMagic;
+                    bool crosses = false;
+                    for (std::size_t i = 1; i < 4; ++i)
+                    {
+                        crosses |= (corners[FaceCorners[f][i]] < mMagic) !=
+                            inside;
+                    }
+
+                    if (!crosses)
+                    {
+                        continue;
+                    }
+
+                    glm::u32vec3 next = cell;
+                    bool valid = true;
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        int c = static_cast<int>(cell[i]) + FaceNeighbours[f][i];
+                        valid &= (c >= 0 && c < static_cast<int>(numCells[i]));
+                        next[i] = static_cast<std::uint32_t>(c);
+                    }
+
+                    if (valid &&
+                        visited.insert(gridIndex(next.x, next.y, next.z), 1))
+                    {
+                        frontier.push(next);
                     }
                 }
             }
 
-            mIndices.resize(mVertices.size());
-            std::iota(std::begin(mIndices), std::end(mIndices), 0);
+            float elapsed = timer.elapsed();
+            std::size_t totalCells = static_cast<std::size_t>(numCells.x) *
+                numCells.y * numCells.z;
+            // Corner samples, the steps taken towards the surface and the
+            // gradient of every vertex.
+            mFieldEvaluations = values.size() + walkEvaluations +
+                vertices.size();
+            mLog << "Sparse cells visited: " << numVisited << " of " <<
+                totalCells << "\n";
+            mLog << "Field samples: " << values.size() << " in " << elapsed <<
+                " seconds\n";
         }
     }
 }
\ No newline at end of file
@@ -1,4 +1,11 @@
 #include "athena/tree/BlobTree.hpp"
+#include "athena/operators/ImplicitOperator.hpp"
+#include "athena/operators/ProfiledOperator.hpp"
+#include "athena/fields/ProfiledField.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
 
 namespace athena
 {
@@ -46,36 +53,307 @@ namespace athena
             // The final index is the parent, so just assign that and clear
             // the copies of the node.
             mVolumeTree = mNodes[tree.size() - 1];
+            buildLeafBvh();
+        }
+
+        void BlobTree::buildLeafBvh()
+        {
+            using atlas::utils::BBox;
+
+            mLeaves.clear();
+            std::vector<Node const*> stack = { mVolumeTree.get() };
+            while (!stack.empty())
+            {
+                auto node = stack.back();
+                stack.pop_back();
+
+                if (node->isLeaf())
+                {
+                    mLeaves.push_back(node);
+                    continue;
+                }
+
+                for (auto& child : node->getChildren())
+                {
+                    stack.push_back(child.get());
+                }
+            }
+
+            std::vector<BBox> boxes;
+            boxes.reserve(mLeaves.size());
+            for (auto leaf : mLeaves)
+            {
+                boxes.push_back(leaf->getBBox());
+            }
+
+            mLeafBvh.build(boxes);
+            mSubTreeCache = std::make_shared<SubTreeCache>();
+            linkLeavesToTape();
+        }
+
+        void BlobTree::linkLeavesToTape()
+        {
+            // Culling only works if every leaf of the tape belongs to
+            // exactly one leaf of the volume tree and vice versa.
+            mLeafInstructions.clear();
+            mUnboundedInstructions.clear();
+            if (mTape.empty() || mLeaves.empty())
+            {
+                return;
+            }
+
+            std::map<fields::ImplicitField const*, std::uint32_t> sources;
+            for (std::size_t i = 0; i < mTape.size(); ++i)
+            {
+                if (!mTape.isLeaf(i))
+                {
+                    continue;
+                }
+
+                auto source = mTape.getSource(i);
+                if (!sources.emplace(source,
+                    static_cast<std::uint32_t>(i)).second)
+                {
+                    return;
+                }
+            }
+
+            if (sources.size() != mLeaves.size())
+            {
+                return;
+            }
+
+            std::vector<std::uint32_t> instructions;
+            instructions.reserve(mLeaves.size());
+            for (auto leaf : mLeaves)
+            {
+                auto it = sources.find(leaf->getField().get());
+                if (it == sources.end())
+                {
+                    return;
+                }
+
+                instructions.push_back(it->second);
+            }
+
+            // The boxes of fields without a compact support (like the
+            // cylinder, which is clipped to its height) don't bound where
+            // they are non-zero, so they can never be culled.
+            for (std::size_t i = 0; i < mLeaves.size(); ++i)
+            {
+                if (!mLeaves[i]->getField()->hasCompactSupport())
+                {
+                    mUnboundedInstructions.push_back(instructions[i]);
+                    instructions[i] = unboundedLeaf;
+                }
+            }
+
+            if (mUnboundedInstructions.size() > maxActiveLeaves)
+            {
+                mUnboundedInstructions.clear();
+                return;
+            }
+
+            mLeafInstructions = std::move(instructions);
+        }
+
+        bool BlobTree::findActiveLeaves(atlas::math::Point const& p,
+            std::uint32_t* active, std::size_t& numActive) const
+        {
+            if (mLeafInstructions.empty() ||
+                !mLeafBvh.query(p, active, maxActiveLeaves, numActive))
+            {
+                return false;
+            }
+
+            // Swap the leaves for their instructions, leaving out the
+            // unbounded ones since those are always added.
+            std::size_t numBounded = 0;
+            for (std::size_t i = 0; i < numActive; ++i)
+            {
+                auto inst = mLeafInstructions[active[i]];
+                if (inst != unboundedLeaf)
+                {
+                    active[numBounded++] = inst;
+                }
+            }
+
+            if (numBounded + mUnboundedInstructions.size() > maxActiveLeaves)
+            {
+                return false;
+            }
+
+            numActive = numBounded;
+            for (auto inst : mUnboundedInstructions)
+            {
+                active[numActive++] = inst;
+            }
+
+            // The tape expects the leaves in the order they appear on it.
+            // There are only a handful of them, so insertion sort is fine.
+            for (std::size_t i = 1; i < numActive; ++i)
+            {
+                auto inst = active[i];
+                std::size_t j = i;
+                for (; j > 0 && active[j - 1] > inst; --j)
+                {
+                    active[j] = active[j - 1];
+                }
+                active[j] = inst;
+            }
+
+            return true;
         }
 
         void BlobTree::insertFieldTree(fields::ImplicitFieldPtr const& tree)
         {
             mFieldTree = tree;
+
+            // Flatten the field tree so that evaluations don't have to go
+            // through a virtual call per node.
+            mTape.clear();
+            mTape.compile(mFieldTree.get());
+            if (!mTape.valid())
+            {
+                mTape.clear();
+            }
+
+            linkLeavesToTape();
         }
 
         float BlobTree::eval(atlas::math::Point const& p) const
         {
-            // Theoretically, we should be able to do this:
-            //using atlas::utils::BBox;
-            //auto subTree = getSubTree(BBox(p, p));
-            //return subTree->eval(p);
+            // Only evaluate the leaves whose support contains the point.
+            // This is the same as evaluating getSubTree(BBox(p, p)) but
+            // without building the pruned tree.
+            std::uint32_t active[maxActiveLeaves];
+            std::size_t numActive;
+            if (findActiveLeaves(p, active, numActive))
+            {
+                return mTape.eval(p, active, numActive);
+            }
+
+            if (!mTape.empty())
+            {
+                return mTape.eval(p);
+            }
+
             return mFieldTree->eval(p);
         }
 
         atlas::math::Normal BlobTree::grad(atlas::math::Point const& p) const
         {
+            std::uint32_t active[maxActiveLeaves];
+            std::size_t numActive;
+            if (findActiveLeaves(p, active, numActive))
+            {
+                return mTape.evalWithGradient(p, active, numActive).gradient;
+            }
+
+            if (!mTape.empty())
+            {
+                return mTape.grad(p);
+            }
+
             return mFieldTree->grad(p);
         }
 
+        fields::FieldSample BlobTree::evalWithGradient(
+            atlas::math::Point const& p) const
+        {
+            std::uint32_t active[maxActiveLeaves];
+            std::size_t numActive;
+            if (findActiveLeaves(p, active, numActive))
+            {
+                return mTape.evalWithGradient(p, active, numActive);
+            }
+
+            if (!mTape.empty())
+            {
+                return mTape.evalWithGradient(p);
+            }
+
+            return mFieldTree->evalWithGradient(p);
+        }
+
         atlas::math::Normal BlobTree::naturalGradient(atlas::math::Point const& p) const
         {
             return mFieldTree->naturalGradient(p);
         }
 
+        void BlobTree::evalBatch(fields::PointBatch const& points,
+            std::vector<float>& values) const
+        {
+            mFieldTree->evalBatch(points, values);
+        }
+
+        void BlobTree::gradBatch(fields::PointBatch const& points,
+            fields::NormalBatch& grads) const
+        {
+            mFieldTree->gradBatch(points, grads);
+        }
+
+        void BlobTree::naturalGradientBatch(fields::PointBatch const& points,
+            fields::NormalBatch& grads) const
+        {
+            mFieldTree->naturalGradientBatch(points, grads);
+        }
+
         fields::ImplicitFieldPtr BlobTree::getSubTree(
             atlas::utils::BBox const& box) const
         {
-            return mVolumeTree->subTree(box);
+            using operators::ImplicitOperator;
+
+            if (!mVolumeTree->getBBox().overlaps(box))
+            {
+                return nullptr;
+            }
+
+            std::vector<std::uint32_t> leafIds;
+            mLeafBvh.query(box, leafIds);
+
+            {
+                std::lock_guard<std::mutex> lock(mSubTreeCache->mutex);
+                auto it = mSubTreeCache->subTrees.find(leafIds);
+                if (it != mSubTreeCache->subTrees.end())
+                {
+                    return it->second;
+                }
+            }
+
+            std::vector<Node const*> leaves;
+            leaves.reserve(leafIds.size());
+            for (auto id : leafIds)
+            {
+                leaves.push_back(mLeaves[id]);
+            }
+            std::sort(leaves.begin(), leaves.end());
+
+            // If the cell is inside the root but misses every leaf, we still
+            // need a field to evaluate, so use an empty root operator.
+            auto subTree = mVolumeTree->subTree(leaves);
+            if (!subTree)
+            {
+                auto op = std::dynamic_pointer_cast<ImplicitOperator>(
+                    mVolumeTree->getField());
+                subTree = op->makeEmpty();
+            }
+
+            std::lock_guard<std::mutex> lock(mSubTreeCache->mutex);
+            auto result = mSubTreeCache->subTrees.emplace(std::move(leafIds),
+                subTree);
+            return result.first->second;
+        }
+
+        void BlobTree::clearSubTreeCache() const
+        {
+            if (!mSubTreeCache)
+            {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(mSubTreeCache->mutex);
+            mSubTreeCache->subTrees.clear();
         }
 
         atlas::utils::BBox BlobTree::getTreeBox() const
@@ -88,5 +366,96 @@ namespace athena
         {
             return mFieldTree->getSeeds(u);
         }
+
+        float BlobTree::maxCullingError(
+            std::vector<atlas::math::Point> const& points) const
+        {
+            float error = 0.0f;
+            for (auto const& p : points)
+            {
+                auto full = (!mTape.empty()) ? mTape.evalWithGradient(p) :
+                    mFieldTree->evalWithGradient(p);
+                auto culled = evalWithGradient(p);
+                auto gradient = grad(p);
+
+                error = std::max(error, std::abs(culled.value - full.value));
+                error = std::max(error, std::abs(eval(p) - full.value));
+                for (int i = 0; i < 3; ++i)
+                {
+                    error = std::max(error,
+                        std::abs(culled.gradient[i] - full.gradient[i]));
+                    error = std::max(error,
+                        std::abs(gradient[i] - full.gradient[i]));
+                }
+            }
+
+            return error;
+        }
+
+        TreePointer BlobTree::makeProfiled(
+            fields::FieldProfiler& profiler) const
+        {
+            using fields::ProfiledField;
+            using operators::ImplicitOperator;
+            using operators::ProfiledOperator;
+
+            std::map<Node const*, int> indices;
+            for (std::size_t i = 0; i < mNodes.size(); ++i)
+            {
+                indices[mNodes[i].get()] = static_cast<int>(i);
+            }
+
+            // Wrap every node in the same order, so the node tree can be
+            // rebuilt with the same indices.
+            std::vector<fields::ImplicitFieldPtr> fields(mNodes.size());
+            std::vector<std::vector<int>> nodeTree(mNodes.size());
+            for (std::size_t i = 0; i < mNodes.size(); ++i)
+            {
+                auto const& node = mNodes[i];
+                if (node->isLeaf())
+                {
+                    auto profile = profiler.addProfile(
+                        "node " + std::to_string(i) + " (leaf)");
+                    fields[i] = std::make_shared<ProfiledField>(
+                        node->getField(), profile);
+                    nodeTree[i].push_back(-1);
+                    continue;
+                }
+
+                auto profile = profiler.addProfile(
+                    "node " + std::to_string(i) + " (operator)");
+                auto op = std::dynamic_pointer_cast<ImplicitOperator>(
+                    node->getField());
+                fields[i] = std::make_shared<ProfiledOperator>(
+                    op->makeEmpty(), profile);
+                for (auto& child : node->getChildren())
+                {
+                    nodeTree[i].push_back(indices[child.get()]);
+                }
+            }
+
+            // The operators can only take their children once all of them
+            // have been wrapped.
+            for (std::size_t i = 0; i < mNodes.size(); ++i)
+            {
+                if (mNodes[i]->isLeaf())
+                {
+                    continue;
+                }
+
+                auto op = std::static_pointer_cast<ImplicitOperator>(
+                    fields[i]);
+                for (auto child : nodeTree[i])
+                {
+                    op->insertField(fields[child]);
+                }
+            }
+
+            auto tree = std::make_shared<BlobTree>();
+            tree->insertFields(fields);
+            tree->insertNodeTree(nodeTree);
+            tree->insertFieldTree(fields[indices[mVolumeTree.get()]]);
+            return tree;
+        }
     }
 }
\ No newline at end of file
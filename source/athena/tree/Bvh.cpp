@@ -0,0 +1,190 @@
+#include "athena/tree/Bvh.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace athena
+{
+    namespace tree
+    {
+        void Bvh::build(std::vector<atlas::utils::BBox> const& boxes)
+        {
+            using atlas::math::Point;
+
+            clear();
+            if (boxes.empty())
+            {
+                return;
+            }
+
+            std::vector<Point> centres;
+            centres.reserve(boxes.size());
+            for (auto& box : boxes)
+            {
+                centres.push_back(0.5f * (box.pMin + box.pMax));
+            }
+
+            mBoxes = boxes;
+            mIndices.resize(boxes.size());
+            std::iota(mIndices.begin(), mIndices.end(), 0);
+            mNodes.reserve(2 * boxes.size());
+
+            buildNode(boxes, centres, 0,
+                static_cast<std::uint32_t>(boxes.size()), 0);
+        }
+
+        void Bvh::clear()
+        {
+            mNodes.clear();
+            mIndices.clear();
+            mBoxes.clear();
+        }
+
+        bool Bvh::empty() const
+        {
+            return mNodes.empty();
+        }
+
+        void Bvh::query(atlas::utils::BBox const& box,
+            std::vector<std::uint32_t>& result) const
+        {
+            result.clear();
+            if (mNodes.empty())
+            {
+                return;
+            }
+
+            std::uint32_t stack[maxDepth + 1];
+            std::size_t top = 0;
+            stack[top++] = 0;
+
+            while (top > 0)
+            {
+                auto idx = stack[--top];
+                auto const& node = mNodes[idx];
+                if (!node.box.overlaps(box))
+                {
+                    continue;
+                }
+
+                if (node.count > 0)
+                {
+                    for (std::uint32_t i = 0; i < node.count; ++i)
+                    {
+                        auto boxIdx = mIndices[node.first + i];
+                        if (mBoxes[boxIdx].overlaps(box))
+                        {
+                            result.push_back(boxIdx);
+                        }
+                    }
+                    continue;
+                }
+
+                stack[top++] = node.right;
+                stack[top++] = idx + 1;
+            }
+
+            std::sort(result.begin(), result.end());
+        }
+
+        bool Bvh::query(atlas::math::Point const& p, std::uint32_t* result,
+            std::size_t maxResults, std::size_t& numResults) const
+        {
+            using atlas::utils::BBox;
+
+            numResults = 0;
+            if (mNodes.empty())
+            {
+                return true;
+            }
+
+            BBox box(p, p);
+            std::uint32_t stack[maxDepth + 1];
+            std::size_t top = 0;
+            stack[top++] = 0;
+
+            while (top > 0)
+            {
+                auto idx = stack[--top];
+                auto const& node = mNodes[idx];
+                if (!node.box.overlaps(box))
+                {
+                    continue;
+                }
+
+                if (node.count > 0)
+                {
+                    for (std::uint32_t i = 0; i < node.count; ++i)
+                    {
+                        auto boxIdx = mIndices[node.first + i];
+                        if (!mBoxes[boxIdx].overlaps(box))
+                        {
+                            continue;
+                        }
+
+                        if (numResults == maxResults)
+                        {
+                            return false;
+                        }
+
+                        result[numResults++] = boxIdx;
+                    }
+                    continue;
+                }
+
+                stack[top++] = node.right;
+                stack[top++] = idx + 1;
+            }
+
+            return true;
+        }
+
+        std::uint32_t Bvh::buildNode(
+            std::vector<atlas::utils::BBox> const& boxes,
+            std::vector<atlas::math::Point> const& centres,
+            std::uint32_t first, std::uint32_t count, std::size_t depth)
+        {
+            using atlas::utils::BBox;
+            using atlas::utils::join;
+
+            auto nodeIdx = static_cast<std::uint32_t>(mNodes.size());
+            mNodes.push_back({ BBox(), first, 0, 0 });
+
+            BBox box = boxes[mIndices[first]];
+            BBox centreBox(centres[mIndices[first]], centres[mIndices[first]]);
+            for (std::uint32_t i = 1; i < count; ++i)
+            {
+                auto idx = mIndices[first + i];
+                box = join(box, boxes[idx]);
+                centreBox = join(centreBox, BBox(centres[idx], centres[idx]));
+            }
+            mNodes[nodeIdx].box = box;
+
+            if (count <= maxLeafSize || depth >= maxDepth - 1)
+            {
+                mNodes[nodeIdx].count = count;
+                return nodeIdx;
+            }
+
+            // Split at the median of the centres along the widest axis.
+            auto extent = centreBox.pMax - centreBox.pMin;
+            int axis = (extent.x > extent.y) ?
+                ((extent.x > extent.z) ? 0 : 2) :
+                ((extent.y > extent.z) ? 1 : 2);
+
+            std::uint32_t half = count / 2;
+            auto begin = mIndices.begin() + first;
+            std::nth_element(begin, begin + half, begin + count,
+                [&centres, axis](std::uint32_t a, std::uint32_t b)
+            {
+                return centres[a][axis] < centres[b][axis];
+            });
+
+            buildNode(boxes, centres, first, half, depth + 1);
+            auto right = buildNode(boxes, centres, first + half, count - half,
+                depth + 1);
+            mNodes[nodeIdx].right = right;
+            return nodeIdx;
+        }
+    }
+}
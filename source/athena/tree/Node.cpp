@@ -1,6 +1,8 @@
 #include "athena/tree/Node.hpp"
 #include "athena/operators/ImplicitOperator.hpp"
 
+#include <algorithm>
+
 namespace athena
 {
     namespace tree
@@ -95,5 +97,54 @@ namespace athena
 
             return result;
         }
+
+        fields::ImplicitFieldPtr Node::subTree(
+            std::vector<Node const*> const& leaves) const
+        {
+            using operators::ImplicitOperatorPtr;
+            using operators::ImplicitOperator;
+
+            if (mChildren.empty())
+            {
+                bool found = std::binary_search(leaves.begin(), leaves.end(),
+                    this);
+                return (found) ? mField : nullptr;
+            }
+
+            // Operators with no surviving children are dropped entirely,
+            // since an empty operator doesn't change the value of its
+            // parent.
+            ImplicitOperatorPtr result;
+            for (auto& child : mChildren)
+            {
+                auto childField = child->subTree(leaves);
+                if (!childField)
+                {
+                    continue;
+                }
+
+                if (!result)
+                {
+                    ImplicitOperatorPtr op =
+                        std::dynamic_pointer_cast<ImplicitOperator>(mField);
+                    assert(op);
+                    result = op->makeEmpty();
+                }
+
+                result->insertField(childField);
+            }
+
+            return result;
+        }
+
+        bool Node::isLeaf() const
+        {
+            return mChildren.empty();
+        }
+
+        fields::ImplicitFieldPtr Node::getField() const
+        {
+            return mField;
+        }
     }
 }
\ No newline at end of file
@@ -14,7 +14,7 @@ namespace athena
 {
     namespace visualizer
     {
-        FieldView::FieldView(tree::BlobTree* tree) : 
+        FieldView::FieldView(tree::TreePointer const& tree) :
             mSliceData(GL_ARRAY_BUFFER),
             mSliceIndices(GL_ELEMENT_ARRAY_BUFFER),
             mSliceNumIndices(0),
@@ -73,6 +73,9 @@ namespace athena
 
             Point height = min;
             std::vector<float> data;
+            fields::PointBatch row(gridSize);
+            std::vector<float> values;
+            fields::NormalBatch grads;
             for (std::size_t i = 0; i < numSlices; ++i)
             {
                 Point start = height;
@@ -85,9 +88,17 @@ namespace athena
                             start[axisMask.x] + x * gridDelta[axisMask.x];
                         pt[axisMask.y] = 
                             start[axisMask.y] + y * gridDelta[axisMask.y];
+                        row.set(y, pt);
+                    }
+
+                    mTree->evalBatch(row, values);
+                    mTree->naturalGradientBatch(row, grads);
 
-                        float f = mTree->eval(pt);
-                        auto grad = mTree->naturalGradient(pt);
+                    for (std::size_t y = 0; y < gridSize; ++y)
+                    {
+                        Point pt = row[y];
+                        float f = values[y];
+                        auto grad = grads[y];
 
                         // Project the gradient.
                         auto projGrad = grad -
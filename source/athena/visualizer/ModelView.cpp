@@ -43,8 +43,12 @@ namespace athena
             mShowMesh(false),
             mShowMCMesh(false),
             mHasMC(false),
+            mHasLattices(false),
+            mHasContours(false),
+            mHasMesh(false),
             mRenderMode(0),
-            mSelectedSlice(0)
+            mSelectedSlice(0),
+            mIsoValue(mSoid.isoValue())
         {
             initShaders();
         }
@@ -71,8 +75,12 @@ namespace athena
             mShowMesh(false),
             mShowMCMesh(false),
             mHasMC(true),
+            mHasLattices(false),
+            mHasContours(false),
+            mHasMesh(false),
             mRenderMode(0),
-            mSelectedSlice(0)
+            mSelectedSlice(0),
+            mIsoValue(mSoid.isoValue())
         {
             initShaders();
         }
@@ -341,6 +349,11 @@ namespace athena
                 mSoid.saveMesh();
             }
 
+            if (ImGui::SliderFloat("Iso-value", &mIsoValue, 0.05f, 0.95f))
+            {
+                updateIsoValue();
+            }
+
             ImGui::Dummy(ImVec2(0, 10));
             ImGui::Text("Visualization Options");
             ImGui::Separator();
@@ -442,16 +455,21 @@ namespace athena
 
         void ModelView::constructLattices()
         {
-            if (!mSoid.getLattice().vertices.empty())
+            if (mHasLattices)
             {
                 return;
             }
 
+            mSoid.constructLattices();
+            uploadLattices();
+            mHasLattices = true;
+        }
+
+        void ModelView::uploadLattices()
+        {
             namespace gl = atlas::gl;
             namespace math = atlas::math;
 
-            mSoid.constructLattices();
-
             auto verts = mSoid.getLattice().vertices;
             auto idx = mSoid.getLattice().indices;
             mLatticeNumIndices = idx.size();
@@ -481,16 +499,21 @@ namespace athena
 
         void ModelView::constructContours()
         {
-            if (!mSoid.getContour().vertices.empty())
+            if (mHasContours)
             {
                 return;
             }
 
+            mSoid.constructContours();
+            uploadContours();
+            mHasContours = true;
+        }
+
+        void ModelView::uploadContours()
+        {
             namespace gl = atlas::gl;
             namespace math = atlas::math;
 
-            mSoid.constructContours();
-
             auto verts = mSoid.getContour().vertices;
             auto idx = mSoid.getContour().indices;
             mContourNumIndices = idx.size();
@@ -519,6 +542,31 @@ namespace athena
             mContourVao.unBindVertexArray();
         }
 
+        void ModelView::updateIsoValue()
+        {
+            // Only rebuild what has already been built. The cross-sections
+            // reuse their field samples, so this is a re-march.
+            mSoid.setIsoValue(mIsoValue);
+            if (!mHasLattices)
+            {
+                return;
+            }
+
+            mSoid.constructLattices();
+            uploadLattices();
+
+            if (mHasContours || mHasMesh)
+            {
+                mSoid.constructContours();
+                uploadContours();
+            }
+
+            if (mHasMesh)
+            {
+                constructMesh();
+            }
+        }
+
         void ModelView::constructMesh()
         {
             // Some condition here.
@@ -526,6 +574,7 @@ namespace athena
             namespace math = atlas::math;
 
             mSoid.constructMesh();
+            mHasMesh = true;
 
             // Update the contour buffers.
             std::vector<atlas::math::Point> verts;